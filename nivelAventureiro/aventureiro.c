@@ -1,12 +1,68 @@
+// Este nível usa select(), read(), ioctl() e clock_gettime(): compila apenas em sistemas POSIX
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <sys/select.h> // select(): espera por entrada sem bloquear as outras partidas
+#include <unistd.h>     // read()
+#include <sys/ioctl.h>  // ioctl(TIOCGWINSZ): tamanho da janela do terminal
 
 // --- Constantes Globais ---
 #define TAM_NOME 30
 #define TAM_COR 10
 #define MIN_TROPAS 2 // Mínimo de tropas para atacar (deve sobrar 1 no atacante)
+#define TAM_BLOCO_LEITURA (1 << 20) // Tamanho de cada bloco lido da entrada no modo lote (1 MiB)
+#define MAX_TROPAS_LOTE 1000000000  // Limite de tropas aceito no modo lote (evita estouro de int)
+#define TAM_LINHA 128               // Tamanho máximo de uma linha de comando de um jogador
+#define MAX_PARTIDAS 64             // Número máximo de partidas simultâneas no escalonador
+#define TEMPO_PENSAMENTO_IA_MS 10   // Tempo que a IA "pensa" antes de cada decisão
+#define MAX_RODADAS_IA 20           // Número de ataques após o qual a IA encerra sua partida
+#define LIMITE_TABELA_MAPA 50       // Acima disso, exibirMapa() mostra só o início (use o visor)
+#define MIN_LINHAS_VISOR 8          // Menor janela de terminal aceita pelo visor
+#define MIN_COLUNAS_VISOR 40
+#define MAX_CORES_ESTATISTICAS 16   // Cores acompanhadas nas séries (a última agrupa as demais)
+#define BATALHAS_POR_DESCARGA 64    // Batalhas entre cada gravação das estatísticas no arquivo
+
+// Blocos do arquivo de estatísticas. Cada bloco tem um cabeçalho de 4 inteiros
+// de 32 bits (tipo, partida, batalha, número de linhas) seguido das colunas,
+// uma após a outra; "batalha" é quantas batalhas a partida já travou. Os
+// contadores de cada bloco são a variação desde o anterior.
+#define BLOCO_DADOS 1       // 6 linhas: face, vezes no ataque, vezes na defesa (u32) + 36 pares (u32)
+#define BLOCO_CORES 2       // Linhas de TAM_COR bytes com o nome de cada cor (índice = linha)
+#define BLOCO_TERRITORIOS 3 // Colunas: id (u32), conquistas (u32), batalhas de posse encerradas (u32)
+                            // (o último bloco fecha a posse aberta de todos os territórios)
+#define BLOCO_SERIE 4       // Colunas: batalha (u32), cor (u32), tropas (u32), territórios (u32)
+
+// Tipos de jogador que alimentam a entrada de uma partida
+#define JOGADOR_HUMANO 0 // Linhas digitadas no terminal (entrada padrão)
+#define JOGADOR_IA 1     // Decisões geradas pelo próprio programa
+#define JOGADOR_SCRIPT 2 // Linhas lidas de um arquivo de comandos
+
+// O que a partida está aguardando do jogador
+#define PEDIDO_NENHUM 0
+#define PEDIDO_MENU 1
+#define PEDIDO_ATACANTE 2
+#define PEDIDO_DEFENSOR 3
+#define PEDIDO_VISOR 4
+
+// ---------------------- CORROTINAS ------------------------------------------
+// Corrotinas sem pilha própria (no estilo "protothreads"): cada função de fase
+// guarda em um inteiro o ponto onde parou e, ao ser chamada de novo, salta
+// para lá com um switch. Variáveis que precisam sobreviver a uma espera ficam
+// na struct Partida. Atenção: o corpo de uma corrotina não pode usar 'switch'.
+#define CORROTINA_ESPERANDO 0
+#define CORROTINA_TERMINADA 1
+#define CORROTINA_INICIO(estado) switch (estado) { case 0:
+#define CORROTINA_ESPERAR(estado, condicao) \
+    do { \
+        if (!(condicao)) { \
+            (estado) = __LINE__; return CORROTINA_ESPERANDO; \
+            case __LINE__: if (!(condicao)) return CORROTINA_ESPERANDO; \
+        } \
+    } while (0)
+#define CORROTINA_FIM(estado) } (estado) = 0; return CORROTINA_TERMINADA
 
 // ---------------------- DEFINIÇÃO DA ESTRUTURA DE DADOS ---------------------
 
@@ -19,23 +75,151 @@ typedef struct {
     int tropas;
 } Territorio;
 
+/**
+ * @brief Visor do mapa: janela rolável e filtrável desenhada no terminal.
+ * Guarda um único quadro (o conteúdo atual da tela) e, a cada desenho,
+ * reescreve com endereçamento de cursor apenas as células que mudaram.
+ */
+typedef struct {
+    int linhas;               // Altura da janela do terminal
+    int colunas;              // Largura da janela do terminal
+    char* quadro;             // Conteúdo atual da tela (linhas * colunas)
+    int quadroValido;         // 0 força repintar a tela inteira (ex: outra partida escreveu na tela)
+    char* saida;              // Sequências de escape acumuladas para um único fwrite
+    int* indices;             // Territórios que passam pelo filtro, em ordem
+    int numIndices;
+    int topo;                 // Posição em 'indices' da primeira linha visível
+    char filtroCor[TAM_COR];      // Dono exigido ("" = qualquer)
+    char filtroPrefixo[TAM_NOME]; // Prefixo exigido no nome ("" = qualquer)
+    char aviso[TAM_LINHA];        // Mensagem mostrada uma vez na linha de status ("" = nenhuma)
+} Visor;
+
+/**
+ * @brief Agregados de uma partida, atualizados a cada batalha e gravados em
+ * blocos colunares no arquivo de estatísticas a cada BATALHAS_POR_DESCARGA batalhas.
+ * Todos os vetores têm tamanho fixo, definido no início da partida.
+ */
+typedef struct {
+    int ativa;                    // 0 quando as estatísticas estão desligadas
+    int idPartida;                // Partida dona dos agregados (gravada nos blocos)
+    const Territorio* mapaBase;   // Início do mapa (para converter ponteiros em índices)
+    int numTerritorios;
+    unsigned int batalha;         // Batalhas já travadas na partida
+
+    // Histogramas dos dados (variação desde a última descarga)
+    unsigned int dadosAtaque[6];
+    unsigned int dadosDefesa[6];
+    unsigned int pares[6][6];     // [dado do atacante - 1][dado do defensor - 1]
+
+    // Contadores por território
+    unsigned int* conquistas;     // Conquistas desde a última descarga
+    unsigned int* batalhasPosse;    // Duração das posses encerradas desde a última descarga
+    unsigned int* inicioPosse;    // Batalha em que o dono atual tomou o território (0 = dono inicial)
+    unsigned char* alterado;      // 1 se o território tem contadores a gravar
+    int* listaAlterados;          // Índices com alterado == 1
+    int numAlterados;
+
+    // Totais por cor e série temporal
+    char cores[MAX_CORES_ESTATISTICAS][TAM_COR];
+    int numCores;
+    int coresGravadas;            // Cores já gravadas no arquivo (BLOCO_CORES)
+    long tropasPorCor[MAX_CORES_ESTATISTICAS];
+    int territoriosPorCor[MAX_CORES_ESTATISTICAS];
+    unsigned int serie[4][BATALHAS_POR_DESCARGA * MAX_CORES_ESTATISTICAS]; // Colunas de BLOCO_SERIE
+    int numAmostras;
+} Estatisticas;
+
+/**
+ * @brief Estado de uma partida executada pelo escalonador.
+ * Guarda o mapa, a origem das entradas do jogador e as variáveis das
+ * corrotinas que precisam sobreviver enquanto a partida espera uma entrada.
+ */
+typedef struct {
+    int id;
+    Territorio* mapa;
+    int numTerritorios;
+
+    // Entrada do jogador
+    int tipoJogador;          // JOGADOR_HUMANO, JOGADOR_IA ou JOGADOR_SCRIPT
+    FILE* script;             // Arquivo de comandos (apenas JOGADOR_SCRIPT)
+    int pedido;               // PEDIDO_* que a partida está aguardando
+    char linha[TAM_LINHA];    // Última linha recebida do jogador
+    int linhaPronta;          // 1 quando 'linha' tem uma entrada ainda não consumida
+    int fimEntrada;           // 1 quando o jogador não tem mais entradas
+    long prontoEm;            // Instante (ms) em que a IA termina de "pensar"
+    int rodadasIA;            // Ataques já feitos pela IA
+
+    // Estado das corrotinas
+    int estadoMenu;
+    int estadoAtaque;
+    int estadoVisor;
+    int escolha;
+    int idAtacante;
+    int idDefensor;
+    int terminada;
+    Visor visor;              // Visor do mapa (alocado no primeiro uso)
+    Estatisticas* estatisticas; // Agregados da partida (NULL quando desligados)
+} Partida;
+
 // ---------------------- PROTÓTIPOS DAS FUNÇÕES -----------------------------
 
 // Funções de Setup e Gerenciamento de Memória
 int lerNumTerritorios();
 Territorio* alocarMapa(int numTerritorios);
 void cadastrarTerritorios(Territorio* mapa, int numTerritorios);
+Territorio* carregarTerritoriosEmLote(FILE* entrada, int* numTerritorios);
+char* lerEntradaCompleta(FILE* entrada, size_t* tamanho);
+int lerCampo(const char** cursor, const char* fimLinha, const char** inicio);
 void liberarMemoria(Territorio* mapa);
 
 // Funções de Lógica Principal do Jogo
 void exibirMapa(const Territorio* mapa, int numTerritorios);
-void faseDeAtaque(Territorio* mapa, int numTerritorios);
+void exibirCabecalhoMapa();
+void exibirTerritorio(const Territorio* mapa, int id);
 void atacar(Territorio* atacante, Territorio* defensor);
 int rolarDado();
 
+// Corrotinas das fases do turno e escalonador de partidas
+int executarMenu(Partida* partida);
+int faseDeAtaque(Partida* partida);
+int lerInteiroDaEntrada(Partida* partida, int* valor);
+void aguardarEntrada(Partida* partida, int pedido);
+void decidirIA(Partida* partida);
+int alimentarEntrada(Partida* partida, long agora);
+int entregarLinhaDoTerminal(Partida* partida);
+void executarEscalonador(Partida* partidas, int numPartidas);
+long agoraMs();
+
+// Visor do mapa (renderização incremental no terminal)
+int navegarMapa(Partida* partida);
+int iniciarVisor(Visor* visor, int numTerritorios);
+void liberarVisor(Visor* visor);
+void aplicarFiltroVisor(Visor* visor, const Territorio* mapa, int numTerritorios);
+int executarComandoVisor(Visor* visor, const char* comando, const Territorio* mapa, int numTerritorios);
+void desenharVisor(Visor* visor, const Territorio* mapa, int numTerritorios);
+
+// Estatísticas das partidas (agregados gravados em arquivo colunar)
+Estatisticas* iniciarEstatisticas(const Territorio* mapa, int numTerritorios, int idPartida);
+int indiceCor(Estatisticas* e, const char* cor);
+void registrarBatalha(const Territorio* antesAtacante, const Territorio* antesDefensor,
+                      const Territorio* atacante, const Territorio* defensor,
+                      int dadoAtacante, int dadoDefensor);
+void gravarBloco(unsigned int tipo, unsigned int partida, unsigned int batalha, unsigned int numLinhas);
+void gravarColuna(const void* dados, size_t tamanho, size_t quantidade);
+void descarregarEstatisticas(Estatisticas* e);
+void finalizarEstatisticas(Estatisticas* e);
+
+// ---------------------- ESTADO GLOBAL ---------------------------------------
+
+// Arquivo de estatísticas (NULL quando desligado) e agregados da partida em execução,
+// definidos pelo escalonador antes de retomar cada partida.
+FILE* arquivoEstatisticas = NULL;
+Estatisticas* estatisticasAtivas = NULL;
+unsigned long falhasEstatisticas = 0; // Gravações incompletas no arquivo de estatísticas
+
 // ---------------------- FUNÇÃO PRINCIPAL (MAIN) -----------------------------
 
-int main() {
+int main(int argc, char* argv[]) {
     // 1. Configuração Inicial (Setup)
     
     // Inicializa a semente para geração de números aleatórios com base no tempo atual.
@@ -44,59 +228,152 @@ int main() {
     
     Territorio* mapa = NULL; // Ponteiro para o início do vetor de territórios.
     int numTerritorios = 0;
-    int escolha;
 
-    // Alocação e Cadastro
-    numTerritorios = lerNumTerritorios();
-    mapa = alocarMapa(numTerritorios);
-    
-    // Verifica se a alocação foi bem-sucedida.
-    if (mapa == NULL) {
-        printf("\nERRO: Falha ao alocar memória. Encerrando o programa.\n");
+    // Opções de linha de comando:
+    //   --lote [arquivo]   cadastra os territórios em lote (ver carregarTerritoriosEmLote)
+    //   --ia N             adiciona N partidas jogadas pela IA, cada uma com uma cópia do mapa
+    //   --script arquivo   adiciona uma partida cujas jogadas são lidas do arquivo
+    //   --estatisticas arq grava histogramas, conquistas e séries no arquivo colunar
+    int modoLote = 0;
+    const char* arquivoLote = NULL;
+    int numPartidasIA = 0;
+    const char* scripts[MAX_PARTIDAS];
+    int numScripts = 0;
+    const char* caminhoEstatisticas = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--lote") == 0) {
+            modoLote = 1;
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+                arquivoLote = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--ia") == 0 && i + 1 < argc) {
+            numPartidasIA = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc && numScripts < MAX_PARTIDAS) {
+            scripts[numScripts++] = argv[++i];
+        } else if (strcmp(argv[i], "--estatisticas") == 0 && i + 1 < argc) {
+            caminhoEstatisticas = argv[++i];
+        }
+    }
+    if (numPartidasIA < 0 || 1 + numPartidasIA + numScripts > MAX_PARTIDAS) {
+        printf("Número de partidas inválido (máximo %d).\n", MAX_PARTIDAS);
         return 1;
     }
-    
-    cadastrarTerritorios(mapa, numTerritorios);
 
-    // 2. Laço Principal do Jogo (Game Loop)
-    do {
-        printf("\n====================================================\n");
-        printf("                MENU DE AÇÕES - WAR\n");
-        printf("====================================================\n");
-        
-        // Exibe o estado atual do mapa antes do menu.
-        exibirMapa(mapa, numTerritorios);
+    // Alocação e Cadastro
+    if (modoLote) {
+        // Modo lote: um território por linha ("nome cor tropas"), lido do arquivo
+        // informado ou, sem arquivo, da entrada padrão.
+        FILE* entrada = stdin;
+        if (arquivoLote != NULL) {
+            entrada = fopen(arquivoLote, "r");
+            if (entrada == NULL) {
+                perror("Erro ao abrir o arquivo de territórios");
+                return 1;
+            }
+        }
+        mapa = carregarTerritoriosEmLote(entrada, &numTerritorios);
+        if (entrada != stdin) {
+            fclose(entrada);
+        }
+        if (mapa == NULL) {
+            return 1;
+        }
+        printf("%d territórios carregados no modo lote.\n", numTerritorios);
+    } else {
+        // A entrada padrão fica sem buffer: o cadastro ainda usa scanf, e o
+        // escalonador lê o restante direto do descritor com read().
+        setvbuf(stdin, NULL, _IONBF, 0);
 
-        printf("\n[1] Iniciar Fase de Ataque\n");
-        printf("[0] Sair do Jogo e Liberar Memória\n");
-        printf("Escolha sua ação: ");
+        numTerritorios = lerNumTerritorios();
+        mapa = alocarMapa(numTerritorios);
         
-        if (scanf("%d", &escolha) != 1) {
-            printf("\nOpção inválida. Por favor, insira um número.\n");
-            // Limpa o buffer em caso de entrada não numérica
-            while (getchar() != '\n'); 
-            escolha = -1; // Garante que o loop continue
-            continue;
+        // Verifica se a alocação foi bem-sucedida.
+        if (mapa == NULL) {
+            printf("\nERRO: Falha ao alocar memória. Encerrando o programa.\n");
+            return 1;
         }
+        
+        cadastrarTerritorios(mapa, numTerritorios);
 
-        switch (escolha) {
-            case 1:
-                faseDeAtaque(mapa, numTerritorios);
-                break;
-            case 0:
-                printf("\nEncerrando o jogo...\n");
-                break;
-            default:
-                printf("\nOpção não reconhecida. Tente novamente.\n");
-                break;
+        // Descarta o fim da última linha lida pelo scanf
+        int c;
+        while ((c = getchar()) != '\n' && c != EOF);
+    }
+
+    // 2. Partidas: a do jogador humano, as da IA e as de script
+    Partida partidas[MAX_PARTIDAS];
+    int numPartidas = 0;
+    memset(partidas, 0, sizeof(partidas));
+
+    partidas[numPartidas].mapa = mapa;
+    partidas[numPartidas].tipoJogador = JOGADOR_HUMANO;
+    numPartidas++;
+    for (int i = 0; i < numPartidasIA + numScripts; i++) {
+        Partida* p = &partidas[numPartidas];
+        p->mapa = alocarMapa(numTerritorios);
+        if (p->mapa == NULL) {
+            printf("\nERRO: Falha ao alocar memória para a partida %d.\n", numPartidas);
+            break;
         }
-        
-    } while (escolha != 0);
+        memcpy(p->mapa, mapa, numTerritorios * sizeof(Territorio));
+        if (i < numPartidasIA) {
+            p->tipoJogador = JOGADOR_IA;
+        } else {
+            p->tipoJogador = JOGADOR_SCRIPT;
+            p->script = fopen(scripts[i - numPartidasIA], "r");
+            if (p->script == NULL) {
+                perror("Erro ao abrir o script");
+                free(p->mapa);
+                continue;
+            }
+        }
+        numPartidas++;
+    }
+    for (int i = 0; i < numPartidas; i++) {
+        partidas[i].id = i;
+        partidas[i].numTerritorios = numTerritorios;
+    }
+
+    if (caminhoEstatisticas != NULL) {
+        arquivoEstatisticas = fopen(caminhoEstatisticas, "wb");
+        if (arquivoEstatisticas == NULL) {
+            perror("Erro ao abrir o arquivo de estatísticas");
+        } else {
+            gravarColuna("WARS", 1, 4);
+            for (int i = 0; i < numPartidas; i++) {
+                partidas[i].estatisticas = iniciarEstatisticas(partidas[i].mapa, numTerritorios, partidas[i].id);
+            }
+        }
+    }
+
+    // 3. Laço Principal do Jogo: o escalonador alterna entre as partidas
+    executarEscalonador(partidas, numPartidas);
 
-    // 3. Limpeza
+    // 4. Limpeza
+    for (int i = 0; i < numPartidas; i++) {
+        liberarVisor(&partidas[i].visor);
+        finalizarEstatisticas(partidas[i].estatisticas);
+    }
+    int estatisticasGravadas = 1;
+    if (arquivoEstatisticas != NULL) {
+        if (fclose(arquivoEstatisticas) != 0) {
+            falhasEstatisticas++;
+        }
+        if (falhasEstatisticas > 0) {
+            fprintf(stderr, "\nErro: falha ao gravar o arquivo de estatísticas (%lu gravações incompletas); o arquivo está incompleto.\n",
+                    falhasEstatisticas);
+            estatisticasGravadas = 0;
+        }
+    }
+    for (int i = 1; i < numPartidas; i++) {
+        free(partidas[i].mapa);
+        if (partidas[i].script != NULL) {
+            fclose(partidas[i].script);
+        }
+    }
     liberarMemoria(mapa);
     
-    return 0;
+    return estatisticasGravadas ? 0 : 1;
 }
 
 // ---------------------- IMPLEMENTAÇÃO DAS FUNÇÕES -----------------------------
@@ -160,6 +437,196 @@ void cadastrarTerritorios(Territorio* mapa, int numTerritorios) {
     }
 }
 
+/**
+ * @brief Lê toda a entrada em blocos grandes (TAM_BLOCO_LEITURA) para um único buffer.
+ * Evita uma chamada de leitura por campo, como acontece com scanf.
+ * @param entrada Arquivo de onde os dados serão lidos.
+ * @param tamanho Ponteiro onde será gravado o número de bytes lidos.
+ * @return O buffer alocado (o chamador deve liberá-lo) ou NULL em caso de falha.
+ */
+char* lerEntradaCompleta(FILE* entrada, size_t* tamanho) {
+    size_t capacidade = TAM_BLOCO_LEITURA;
+    size_t usado = 0;
+    char* buffer = (char*)malloc(capacidade);
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    size_t lidos;
+    while ((lidos = fread(buffer + usado, 1, capacidade - usado, entrada)) > 0) {
+        usado += lidos;
+        if (usado == capacidade) {
+            // Buffer cheio: dobra a capacidade antes do próximo bloco
+            char* maior = (char*)realloc(buffer, capacidade * 2);
+            if (maior == NULL) {
+                free(buffer);
+                return NULL;
+            }
+            buffer = maior;
+            capacidade *= 2;
+        }
+    }
+    if (ferror(entrada)) {
+        free(buffer);
+        return NULL;
+    }
+
+    *tamanho = usado;
+    return buffer;
+}
+
+/**
+ * @brief Tokenizador do modo lote: localiza o próximo campo da linha atual.
+ * Campos são separados por espaços, tabulações ou '\r'.
+ * @param cursor Ponteiro para a posição atual na linha (avança até o fim do campo).
+ * @param fimLinha Ponteiro para o fim da linha atual.
+ * @param inicio Ponteiro onde será gravado o início do campo encontrado.
+ * @return O comprimento do campo, ou 0 se a linha não tem mais campos.
+ */
+int lerCampo(const char** cursor, const char* fimLinha, const char** inicio) {
+    const char* p = *cursor;
+    while (p < fimLinha && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        p++;
+    }
+    *inicio = p;
+    while (p < fimLinha && *p != ' ' && *p != '\t' && *p != '\r') {
+        p++;
+    }
+    *cursor = p;
+    return (int)(p - *inicio);
+}
+
+/**
+ * @brief Cadastra os territórios a partir de uma entrada em lote (um por linha).
+ * Cada linha tem o formato "nome cor tropas"; linhas em branco são ignoradas.
+ * Aplica as mesmas validações do cadastro interativo (tamanho do nome e da cor,
+ * mínimo de MIN_TROPAS tropas e pelo menos 2 territórios) e informa todos os
+ * erros encontrados com o número da linha.
+ * @param entrada Arquivo de onde os territórios serão lidos.
+ * @param numTerritorios Ponteiro onde será gravado o número de territórios lidos.
+ * @return O vetor de territórios alocado, ou NULL se houver erros.
+ */
+Territorio* carregarTerritoriosEmLote(FILE* entrada, int* numTerritorios) {
+    size_t tamanho = 0;
+    char* buffer = lerEntradaCompleta(entrada, &tamanho);
+    if (buffer == NULL) {
+        fprintf(stderr, "ERRO: Falha ao ler a entrada do modo lote.\n");
+        return NULL;
+    }
+    const char* fim = buffer + tamanho;
+
+    // 1. Conta as linhas para alocar o mapa uma única vez
+    int numLinhas = 1;
+    for (const char* p = buffer; (p = memchr(p, '\n', fim - p)) != NULL; p++) {
+        numLinhas++;
+    }
+    Territorio* mapa = alocarMapa(numLinhas);
+    if (mapa == NULL) {
+        fprintf(stderr, "ERRO: Falha ao alocar memória para %d territórios.\n", numLinhas);
+        free(buffer);
+        return NULL;
+    }
+
+    // 2. Analisa cada linha com o tokenizador
+    int n = 0;
+    int erros = 0;
+    int linha = 0;
+    for (const char* p = buffer; p < fim; ) {
+        linha++;
+        const char* fimLinha = memchr(p, '\n', fim - p);
+        if (fimLinha == NULL) {
+            fimLinha = fim;
+        }
+
+        const char* cursor = p;
+        const char* campo[3];
+        int comprimento[3];
+        int numCampos = 0;
+        const char* inicio;
+        int comp;
+        while ((comp = lerCampo(&cursor, fimLinha, &inicio)) > 0) {
+            if (numCampos < 3) {
+                campo[numCampos] = inicio;
+                comprimento[numCampos] = comp;
+            }
+            numCampos++;
+        }
+        p = fimLinha + 1;
+
+        if (numCampos == 0) {
+            continue; // Linha em branco
+        }
+        if (numCampos != 3) {
+            fprintf(stderr, "Linha %d: esperados 3 campos (nome cor tropas), encontrados %d.\n", linha, numCampos);
+            erros++;
+            continue;
+        }
+        if (comprimento[0] > TAM_NOME - 1) {
+            fprintf(stderr, "Linha %d: nome com mais de %d caracteres.\n", linha, TAM_NOME - 1);
+            erros++;
+            continue;
+        }
+        if (comprimento[1] > TAM_COR - 1) {
+            fprintf(stderr, "Linha %d: cor com mais de %d caracteres.\n", linha, TAM_COR - 1);
+            erros++;
+            continue;
+        }
+
+        // Conversão manual das tropas (apenas dígitos, sem estouro)
+        const char* d = campo[2];
+        const char* fimCampo = campo[2] + comprimento[2];
+        int negativo = (*d == '-');
+        if (*d == '-' || *d == '+') {
+            d++;
+        }
+        // long long, como em novato.c: o valor pode chegar a 10 * MAX_TROPAS_LOTE + 9,
+        // que não cabe em 'long' nas plataformas onde ele tem 32 bits.
+        long long tropas = 0;
+        int valido = (d < fimCampo);
+        for (; d < fimCampo && valido; d++) {
+            if (*d < '0' || *d > '9') {
+                valido = 0;
+            } else if (tropas <= MAX_TROPAS_LOTE) {
+                tropas = tropas * 10 + (*d - '0');
+            }
+        }
+        if (!valido) {
+            fprintf(stderr, "Linha %d: número de tropas inválido (\"%.*s\").\n", linha, comprimento[2], campo[2]);
+            erros++;
+            continue;
+        }
+        if (negativo || tropas < MIN_TROPAS) {
+            fprintf(stderr, "Linha %d: o território deve ter pelo menos %d tropas.\n", linha, MIN_TROPAS);
+            erros++;
+            continue;
+        }
+        if (tropas > MAX_TROPAS_LOTE) {
+            fprintf(stderr, "Linha %d: número de tropas acima do limite (%d).\n", linha, MAX_TROPAS_LOTE);
+            erros++;
+            continue;
+        }
+
+        memcpy((mapa + n)->nome, campo[0], comprimento[0]);
+        memcpy((mapa + n)->cor, campo[1], comprimento[1]);
+        (mapa + n)->tropas = (int)tropas;
+        n++;
+    }
+    free(buffer);
+
+    if (erros == 0 && n < 2) {
+        fprintf(stderr, "ERRO: São necessários pelo menos 2 territórios (encontrados %d).\n", n);
+        erros++;
+    }
+    if (erros > 0) {
+        fprintf(stderr, "Cadastro em lote cancelado: %d erro(s) encontrado(s).\n", erros);
+        free(mapa);
+        return NULL;
+    }
+
+    *numTerritorios = n;
+    return mapa;
+}
+
 /**
  * @brief Libera a memória previamente alocada dinamicamente.
  * @param mapa Ponteiro para o início da memória a ser liberada.
@@ -172,26 +639,48 @@ void liberarMemoria(Territorio* mapa) {
 }
 
 /**
- * @brief Exibe o estado atual de todos os territórios no mapa.
+ * @brief Exibe o estado atual dos territórios no mapa.
+ * Mapas com mais de LIMITE_TABELA_MAPA territórios mostram apenas o início.
  * @param mapa Ponteiro constante para o primeiro elemento (apenas leitura).
  * @param numTerritorios O tamanho do vetor.
  */
 void exibirMapa(const Territorio* mapa, int numTerritorios) {
-    printf("\n----------------------- MAPA ATUAL ------------------------\n");
-    printf("| %-4s | %-30s | %-10s | %-6s |\n", "ID", "NOME", "DONO", "TROPAS");
-    printf("|------|--------------------------------|------------|--------|\n");
+    exibirCabecalhoMapa();
     
-    for (int i = 0; i < numTerritorios; i++) {
-        // Acesso aos campos do struct através de ponteiro constante.
-        printf("| %-4d | %-30s | %-10s | %-6d |\n", 
-               i, 
-               (mapa + i)->nome, 
-               (mapa + i)->cor, 
-               (mapa + i)->tropas);
+    // Mapas grandes mostram apenas o início; o restante fica no visor do mapa.
+    int exibidos = numTerritorios <= LIMITE_TABELA_MAPA ? numTerritorios : LIMITE_TABELA_MAPA;
+    for (int i = 0; i < exibidos; i++) {
+        exibirTerritorio(mapa, i);
+    }
+    if (exibidos < numTerritorios) {
+        printf("| ... mais %d territórios (use a opção [2] para navegar pelo mapa)\n", numTerritorios - exibidos);
     }
     printf("-----------------------------------------------------------\n");
 }
 
+/**
+ * @brief Exibe o título e o cabeçalho da tabela do mapa.
+ */
+void exibirCabecalhoMapa() {
+    printf("\n----------------------- MAPA ATUAL ------------------------\n");
+    printf("| %-4s | %-30s | %-10s | %-6s |\n", "ID", "NOME", "DONO", "TROPAS");
+    printf("|------|--------------------------------|------------|--------|\n");
+}
+
+/**
+ * @brief Exibe uma linha da tabela do mapa.
+ * @param mapa Ponteiro constante para o primeiro elemento (apenas leitura).
+ * @param id Índice do território a exibir.
+ */
+void exibirTerritorio(const Territorio* mapa, int id) {
+    // Acesso aos campos do struct através de ponteiro constante.
+    printf("| %-4d | %-30s | %-10s | %-6d |\n", 
+           id, 
+           (mapa + id)->nome, 
+           (mapa + id)->cor, 
+           (mapa + id)->tropas);
+}
+
 /**
  * @brief Simula a rolagem de um dado (número aleatório entre 1 e 6).
  * @return O valor do dado rolado.
@@ -202,60 +691,366 @@ int rolarDado() {
 }
 
 /**
- * @brief Gerencia a interface e a lógica de seleção de territórios para o ataque.
- * @param mapa Ponteiro para o vetor de territórios.
- * @param numTerritorios O tamanho do vetor.
+ * @brief Marca que a partida aguarda uma entrada do jogador.
+ * A IA começa a "pensar" a partir deste instante.
+ * @param partida Ponteiro para a partida.
+ * @param pedido O que está sendo aguardado (PEDIDO_*).
  */
-void faseDeAtaque(Territorio* mapa, int numTerritorios) {
-    int idAtacante, idDefensor;
-    
+void aguardarEntrada(Partida* partida, int pedido) {
+    partida->pedido = pedido;
+    partida->linhaPronta = 0;
+    partida->prontoEm = agoraMs() + TEMPO_PENSAMENTO_IA_MS;
+    fflush(stdout);
+}
+
+/**
+ * @brief Consome a linha recebida pela partida e a converte em inteiro.
+ * @param partida Ponteiro para a partida.
+ * @param valor Ponteiro onde o número lido será gravado.
+ * @return 1 se a linha continha um número, 0 caso contrário.
+ */
+int lerInteiroDaEntrada(Partida* partida, int* valor) {
+    partida->pedido = PEDIDO_NENHUM;
+    partida->linhaPronta = 0;
+    return sscanf(partida->linha, "%d", valor) == 1;
+}
+
+/**
+ * @brief Corrotina do menu de ações (um turno por volta do laço).
+ * @param partida Ponteiro para a partida.
+ * @return CORROTINA_ESPERANDO enquanto aguarda entrada, CORROTINA_TERMINADA ao sair.
+ */
+int executarMenu(Partida* partida) {
+    CORROTINA_INICIO(partida->estadoMenu);
+
+    do {
+        printf("\n====================================================\n");
+        printf("                MENU DE AÇÕES - WAR\n");
+        printf("====================================================\n");
+        
+        // Exibe o estado atual do mapa antes do menu.
+        exibirMapa(partida->mapa, partida->numTerritorios);
+
+        printf("\n[1] Iniciar Fase de Ataque\n");
+        printf("[2] Navegar pelo Mapa (janela com filtros)\n");
+        printf("[0] Sair do Jogo e Liberar Memória\n");
+        printf("Escolha sua ação: ");
+
+        aguardarEntrada(partida, PEDIDO_MENU);
+        CORROTINA_ESPERAR(partida->estadoMenu, partida->linhaPronta || partida->fimEntrada);
+        if (!partida->linhaPronta) {
+            printf("\nFim da entrada. Encerrando o jogo...\n");
+            break;
+        }
+        if (!lerInteiroDaEntrada(partida, &partida->escolha)) {
+            printf("\nOpção inválida. Por favor, insira um número.\n");
+            partida->escolha = -1; // Garante que o loop continue
+            continue;
+        }
+
+        if (partida->escolha == 1) {
+            // A fase de ataque é uma corrotina aninhada: o menu espera até ela terminar
+            CORROTINA_ESPERAR(partida->estadoMenu, faseDeAtaque(partida) == CORROTINA_TERMINADA);
+        } else if (partida->escolha == 2) {
+            CORROTINA_ESPERAR(partida->estadoMenu, navegarMapa(partida) == CORROTINA_TERMINADA);
+        } else if (partida->escolha == 0) {
+            printf("\nEncerrando o jogo...\n");
+        } else {
+            printf("\nOpção não reconhecida. Tente novamente.\n");
+        }
+    } while (partida->escolha != 0);
+
+    CORROTINA_FIM(partida->estadoMenu);
+}
+
+/**
+ * @brief Corrotina que gerencia a seleção de territórios e executa o ataque.
+ * Se a entrada do jogador acabar no meio da fase, o ataque é cancelado.
+ * @param partida Ponteiro para a partida.
+ * @return CORROTINA_ESPERANDO enquanto aguarda entrada, CORROTINA_TERMINADA ao concluir.
+ */
+int faseDeAtaque(Partida* partida) {
+    Territorio* mapa = partida->mapa;
+    int numTerritorios = partida->numTerritorios;
+
+    CORROTINA_INICIO(partida->estadoAtaque);
+
     printf("\n--- INÍCIO DA FASE DE ATAQUE ---\n");
     
     // 1. Escolha do atacante e validação
     do {
         printf("ID do Território ATACANTE: ");
-        scanf("%d", &idAtacante);
+        aguardarEntrada(partida, PEDIDO_ATACANTE);
+        CORROTINA_ESPERAR(partida->estadoAtaque, partida->linhaPronta || partida->fimEntrada);
+        if (!partida->linhaPronta) {
+            printf("\nFim da entrada. Ataque cancelado.\n");
+            break;
+        }
+        if (!lerInteiroDaEntrada(partida, &partida->idAtacante)) {
+            partida->idAtacante = -1;
+        }
         
         // Verifica se o ID é válido
-        if (idAtacante < 0 || idAtacante >= numTerritorios) {
+        if (partida->idAtacante < 0 || partida->idAtacante >= numTerritorios) {
             printf("ID inválido. Escolha um ID entre 0 e %d.\n", numTerritorios - 1);
             continue;
         }
         
         // Valida se o atacante tem tropas suficientes
-        if ((mapa + idAtacante)->tropas < MIN_TROPAS) {
+        if ((mapa + partida->idAtacante)->tropas < MIN_TROPAS) {
             printf("Território %s não tem tropas suficientes (mínimo %d). Escolha outro.\n", 
-                   (mapa + idAtacante)->nome, MIN_TROPAS);
+                   (mapa + partida->idAtacante)->nome, MIN_TROPAS);
         }
-    } while (idAtacante < 0 || idAtacante >= numTerritorios || (mapa + idAtacante)->tropas < MIN_TROPAS);
+    } while (partida->idAtacante < 0 || partida->idAtacante >= numTerritorios ||
+             (mapa + partida->idAtacante)->tropas < MIN_TROPAS);
 
     // 2. Escolha do defensor e validação
-    do {
+    while (!partida->fimEntrada || partida->linhaPronta) {
         printf("ID do Território DEFENSOR: ");
-        scanf("%d", &idDefensor);
+        aguardarEntrada(partida, PEDIDO_DEFENSOR);
+        CORROTINA_ESPERAR(partida->estadoAtaque, partida->linhaPronta || partida->fimEntrada);
+        if (!partida->linhaPronta) {
+            printf("\nFim da entrada. Ataque cancelado.\n");
+            break;
+        }
+        if (!lerInteiroDaEntrada(partida, &partida->idDefensor)) {
+            partida->idDefensor = -1;
+        }
         
         // Verifica se o ID é válido
-        if (idDefensor < 0 || idDefensor >= numTerritorios || idDefensor == idAtacante) {
+        if (partida->idDefensor < 0 || partida->idDefensor >= numTerritorios ||
+            partida->idDefensor == partida->idAtacante) {
             printf("ID inválido ou igual ao atacante. Escolha um ID diferente entre 0 e %d.\n", numTerritorios - 1);
             continue;
         }
         
         // Validação: não pode atacar território da mesma cor.
-        if (strcmp((mapa + idAtacante)->cor, (mapa + idDefensor)->cor) == 0) {
+        if (strcmp((mapa + partida->idAtacante)->cor, (mapa + partida->idDefensor)->cor) == 0) {
             printf("Não é possível atacar um território da mesma cor (%s). Escolha outro defensor.\n", 
-                   (mapa + idDefensor)->cor);
+                   (mapa + partida->idDefensor)->cor);
+            continue;
         }
-    } while (idDefensor < 0 || idDefensor >= numTerritorios || idDefensor == idAtacante || 
-             strcmp((mapa + idAtacante)->cor, (mapa + idDefensor)->cor) == 0);
-             
-    // 3. Execução do ataque, passando os ponteiros para as structs.
-    // &mapa[id] ou (mapa + id) obtêm o endereço do struct no vetor.
-    atacar((mapa + idAtacante), (mapa + idDefensor));
 
-    printf("\n--- RESULTADO DA BATALHA ---\n");
-    exibirMapa(mapa, numTerritorios); // Exibe o mapa atualizado
+        // 3. Execução do ataque, passando os ponteiros para as structs.
+        // &mapa[id] ou (mapa + id) obtêm o endereço do struct no vetor.
+        atacar((mapa + partida->idAtacante), (mapa + partida->idDefensor));
+
+        // Exibe só os dois territórios envolvidos, qualquer que seja o tamanho do mapa
+        printf("\n--- RESULTADO DA BATALHA ---\n");
+        exibirCabecalhoMapa();
+        exibirTerritorio(mapa, partida->idAtacante);
+        exibirTerritorio(mapa, partida->idDefensor);
+        printf("-----------------------------------------------------------\n");
+        break;
+    }
+
+    CORROTINA_FIM(partida->estadoAtaque);
 }
 
+/**
+ * @brief Gera a próxima jogada da IA e a grava como a linha de entrada da partida.
+ * Ataca com um território qualquer que tenha tropas suficientes e um inimigo;
+ * sai do jogo quando não há ataques possíveis ou após MAX_RODADAS_IA ataques.
+ * @param partida Ponteiro para a partida (a entrada pendente é preenchida).
+ */
+void decidirIA(Partida* partida) {
+    const Territorio* mapa = partida->mapa;
+    int n = partida->numTerritorios;
+    int escolha = -1;
+
+    if (partida->pedido == PEDIDO_MENU || partida->pedido == PEDIDO_ATACANTE) {
+        // Procura, a partir de uma posição sorteada, um atacante que tenha algum inimigo
+        int inicio = rand() % n;
+        for (int k = 0; k < n && escolha < 0; k++) {
+            int i = (inicio + k) % n;
+            if ((mapa + i)->tropas < MIN_TROPAS) continue;
+            for (int j = 0; j < n; j++) {
+                if (strcmp((mapa + i)->cor, (mapa + j)->cor) != 0) {
+                    escolha = i;
+                    break;
+                }
+            }
+        }
+        if (partida->pedido == PEDIDO_MENU) {
+            escolha = (escolha >= 0 && partida->rodadasIA < MAX_RODADAS_IA) ? 1 : 0;
+        }
+    } else if (partida->pedido == PEDIDO_DEFENSOR) {
+        int inicio = rand() % n;
+        for (int k = 0; k < n && escolha < 0; k++) {
+            int j = (inicio + k) % n;
+            if (strcmp((mapa + partida->idAtacante)->cor, (mapa + j)->cor) != 0) {
+                escolha = j;
+            }
+        }
+        partida->rodadasIA++;
+    }
+
+    snprintf(partida->linha, TAM_LINHA, "%d\n", escolha);
+}
+
+/**
+ * @brief Tenta entregar à partida a entrada que ela está aguardando, sem bloquear.
+ * A IA responde depois de TEMPO_PENSAMENTO_IA_MS; o script lê a próxima linha
+ * do arquivo. Entradas do terminal são entregues pelo escalonador.
+ * @param partida Ponteiro para a partida.
+ * @param agora Instante atual em milissegundos.
+ * @return 1 se a partida pode continuar agora, 0 se ainda está esperando.
+ */
+int alimentarEntrada(Partida* partida, long agora) {
+    if (partida->pedido == PEDIDO_NENHUM || partida->linhaPronta || partida->fimEntrada) {
+        return 1;
+    }
+    if (partida->tipoJogador == JOGADOR_IA) {
+        if (agora < partida->prontoEm) {
+            return 0;
+        }
+        decidirIA(partida);
+    } else if (partida->tipoJogador == JOGADOR_SCRIPT) {
+        if (fgets(partida->linha, TAM_LINHA, partida->script) == NULL) {
+            partida->fimEntrada = 1;
+            return 1;
+        }
+    } else {
+        return entregarLinhaDoTerminal(partida);
+    }
+
+    // Jogadas que não vêm do terminal são ecoadas, como se tivessem sido digitadas
+    printf("%s", partida->linha);
+    if (strchr(partida->linha, '\n') == NULL) {
+        printf("\n");
+    }
+    partida->linhaPronta = 1;
+    return 1;
+}
+
+// Buffer das linhas lidas do terminal que ainda não foram entregues a uma partida
+char bufferTerminal[4096];
+size_t usadoTerminal = 0;
+int fimTerminal = 0;
+
+/**
+ * @brief Entrega a uma partida humana a próxima linha completa já lida do terminal.
+ * @param partida Ponteiro para a partida humana que aguarda entrada.
+ * @return 1 se a partida recebeu uma linha (ou o fim da entrada), 0 caso contrário.
+ */
+int entregarLinhaDoTerminal(Partida* partida) {
+    char* fimLinha = memchr(bufferTerminal, '\n', usadoTerminal);
+    size_t tamanho;
+    if (fimLinha != NULL) {
+        tamanho = (size_t)(fimLinha - bufferTerminal) + 1;
+    } else if (usadoTerminal == sizeof(bufferTerminal) || (fimTerminal && usadoTerminal > 0)) {
+        tamanho = usadoTerminal; // Linha longa demais ou última linha sem '\n'
+    } else {
+        if (fimTerminal) {
+            partida->fimEntrada = 1;
+            return 1;
+        }
+        return 0;
+    }
+
+    size_t copiar = tamanho < TAM_LINHA ? tamanho : TAM_LINHA - 1;
+    memcpy(partida->linha, bufferTerminal, copiar);
+    partida->linha[copiar] = '\0';
+    memmove(bufferTerminal, bufferTerminal + tamanho, usadoTerminal - tamanho);
+    usadoTerminal -= tamanho;
+    partida->linhaPronta = 1;
+    return 1;
+}
+
+/**
+ * @brief Retorna o instante atual, em milissegundos, de um relógio monotônico.
+ */
+long agoraMs() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (long)t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Escalonador: executa as partidas em rodízio até todas terminarem.
+ * Cada partida avança até precisar de uma entrada que ainda não chegou.
+ * Quando nenhuma pode avançar, o processo dorme em select() até o terminal
+ * ter dados ou a próxima IA terminar de pensar, sem gastar CPU.
+ * @param partidas Vetor de partidas.
+ * @param numPartidas Número de partidas no vetor.
+ */
+void executarEscalonador(Partida* partidas, int numPartidas) {
+    int ultimaExecutada = -1;
+
+    while (1) {
+        int ativas = 0;
+        int avancou = 0;
+        int aguardandoTerminal = 0;
+        long agora = agoraMs();
+        long proximoPrazo = -1;
+
+        for (int i = 0; i < numPartidas; i++) {
+            Partida* p = &partidas[i];
+            if (p->terminada) continue;
+            ativas++;
+
+            if (!alimentarEntrada(p, agora)) {
+                if (p->tipoJogador == JOGADOR_HUMANO) {
+                    aguardandoTerminal = 1;
+                } else if (proximoPrazo < 0 || p->prontoEm < proximoPrazo) {
+                    proximoPrazo = p->prontoEm;
+                }
+                continue;
+            }
+
+            if (numPartidas > 1 && ultimaExecutada != i) {
+                printf("\n>>>>>>>>>>>>>>>>>>>>>> PARTIDA %d <<<<<<<<<<<<<<<<<<<<<<\n", p->id);
+            }
+            ultimaExecutada = i;
+            estatisticasAtivas = p->estatisticas;
+            if (executarMenu(p) == CORROTINA_TERMINADA) {
+                p->terminada = 1;
+            }
+            estatisticasAtivas = NULL;
+            avancou = 1;
+
+            // O que esta partida escreveu sujou a tela: um visor aberto em outra
+            // partida não pode confiar no seu quadro e repinta tudo no próximo desenho
+            for (int k = 0; k < numPartidas; k++) {
+                if (k != i) {
+                    partidas[k].visor.quadroValido = 0;
+                }
+            }
+        }
+
+        if (ativas == 0) {
+            break;
+        }
+        if (avancou) {
+            continue;
+        }
+
+        // Nenhuma partida pode avançar: dorme até o terminal ou a próxima IA
+        fflush(stdout);
+        fd_set leitura;
+        FD_ZERO(&leitura);
+        if (aguardandoTerminal && !fimTerminal) {
+            FD_SET(STDIN_FILENO, &leitura);
+        }
+        struct timeval espera;
+        struct timeval* limite = NULL;
+        if (proximoPrazo >= 0) {
+            long ms = proximoPrazo - agoraMs();
+            if (ms < 0) ms = 0;
+            espera.tv_sec = ms / 1000;
+            espera.tv_usec = (ms % 1000) * 1000;
+            limite = &espera;
+        }
+        if (select(STDIN_FILENO + 1, &leitura, NULL, NULL, limite) > 0 && FD_ISSET(STDIN_FILENO, &leitura)) {
+            ssize_t lidos = read(STDIN_FILENO, bufferTerminal + usadoTerminal, sizeof(bufferTerminal) - usadoTerminal);
+            if (lidos <= 0) {
+                fimTerminal = 1;
+            } else {
+                usadoTerminal += (size_t)lidos;
+            }
+        }
+    }
+}
 
 /**
  * @brief Simula a lógica de uma batalha e atualiza as tropas/donos.
@@ -268,6 +1063,10 @@ void atacar(Territorio* atacante, Territorio* defensor) {
     printf("\nBatalha: %s (%s) ataca %s (%s)!\n", 
            atacante->nome, atacante->cor, defensor->nome, defensor->cor);
 
+    // Estado anterior, usado pelas estatísticas para atualizar os totais por cor
+    Territorio antesAtacante = *atacante;
+    Territorio antesDefensor = *defensor;
+
     int dadoAtacante = rolarDado();
     int dadoDefensor = rolarDado();
 
@@ -308,4 +1107,500 @@ void atacar(Territorio* atacante, Territorio* defensor) {
             printf("O atacante %s não pode perder mais tropas (mínimo 1 mantido).\n", atacante->nome);
         }
     }
-}
\ No newline at end of file
+
+    registrarBatalha(&antesAtacante, &antesDefensor, atacante, defensor, dadoAtacante, dadoDefensor);
+}
+
+// ---------------------- VISOR DO MAPA ---------------------------------------
+
+/**
+ * @brief Prepara o visor: mede a janela do terminal e aloca o quadro.
+ * @param visor Ponteiro para o visor (já alocado não é realocado).
+ * @param numTerritorios Tamanho do mapa (capacidade do índice do filtro).
+ * @return 1 em caso de sucesso, 0 em caso de falha de alocação.
+ */
+int iniciarVisor(Visor* visor, int numTerritorios) {
+    if (visor->quadro != NULL) {
+        return 1;
+    }
+
+    // Tamanho da janela; sem terminal, usa o padrão 24x80
+    struct winsize janela;
+    visor->linhas = 24;
+    visor->colunas = 80;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &janela) == 0 && janela.ws_row > 0 && janela.ws_col > 0) {
+        visor->linhas = janela.ws_row;
+        visor->colunas = janela.ws_col;
+    }
+    if (visor->linhas < MIN_LINHAS_VISOR) visor->linhas = MIN_LINHAS_VISOR;
+    if (visor->colunas < MIN_COLUNAS_VISOR) visor->colunas = MIN_COLUNAS_VISOR;
+
+    // Pior caso da saída: cada célula precedida de uma sequência de cursor
+    visor->quadro = (char*)malloc((size_t)visor->linhas * visor->colunas);
+    visor->saida = (char*)malloc((size_t)visor->linhas * (visor->colunas + 32) + 64);
+    visor->indices = (int*)malloc((numTerritorios > 0 ? numTerritorios : 1) * sizeof(int));
+    if (visor->quadro == NULL || visor->saida == NULL || visor->indices == NULL) {
+        liberarVisor(visor);
+        return 0;
+    }
+    visor->quadroValido = 0;
+    visor->topo = 0;
+    visor->filtroCor[0] = '\0';
+    visor->filtroPrefixo[0] = '\0';
+    visor->aviso[0] = '\0';
+    return 1;
+}
+
+/**
+ * @brief Libera a memória do visor (pode ser chamado em um visor nunca iniciado).
+ * @param visor Ponteiro para o visor.
+ */
+void liberarVisor(Visor* visor) {
+    free(visor->quadro);
+    free(visor->saida);
+    free(visor->indices);
+    visor->quadro = NULL;
+    visor->saida = NULL;
+    visor->indices = NULL;
+}
+
+/**
+ * @brief Recalcula a lista de territórios que passam pelos filtros de dono e prefixo.
+ * É o único passo do visor que percorre o mapa inteiro, e só roda quando o
+ * filtro muda ou o visor é aberto.
+ * @param visor Ponteiro para o visor.
+ * @param mapa Ponteiro constante para o vetor de territórios.
+ * @param numTerritorios O tamanho do vetor.
+ */
+void aplicarFiltroVisor(Visor* visor, const Territorio* mapa, int numTerritorios) {
+    size_t tamanhoPrefixo = strlen(visor->filtroPrefixo);
+    visor->numIndices = 0;
+    for (int i = 0; i < numTerritorios; i++) {
+        if (visor->filtroCor[0] != '\0' && strcmp((mapa + i)->cor, visor->filtroCor) != 0) continue;
+        if (tamanhoPrefixo > 0 && strncmp((mapa + i)->nome, visor->filtroPrefixo, tamanhoPrefixo) != 0) continue;
+        visor->indices[visor->numIndices++] = i;
+    }
+    visor->topo = 0;
+}
+
+/**
+ * @brief Executa um comando digitado no visor.
+ * Comandos: j/k (linha abaixo/acima), f ou Enter/b (página seguinte/anterior),
+ * i N (ir para o território N), c COR (filtrar por dono), p PREFIXO (filtrar
+ * pelo início do nome), c ou p sozinhos limpam o filtro, q (sair).
+ * @param visor Ponteiro para o visor.
+ * @param comando Linha digitada pelo jogador.
+ * @param mapa Ponteiro constante para o vetor de territórios.
+ * @param numTerritorios O tamanho do vetor.
+ * @return 0 se o jogador saiu do visor, 1 caso contrário.
+ */
+int executarComandoVisor(Visor* visor, const char* comando, const Territorio* mapa, int numTerritorios) {
+    int areaDados = visor->linhas - 5;
+    char acao = 'f';
+    char argumento[TAM_NOME] = "";
+    sscanf(comando, " %c %29s", &acao, argumento);
+
+    if (acao == 'q') {
+        return 0;
+    } else if (acao == 'j') {
+        visor->topo++;
+    } else if (acao == 'k') {
+        visor->topo--;
+    } else if (acao == 'f') {
+        visor->topo += areaDados;
+    } else if (acao == 'b') {
+        visor->topo -= areaDados;
+    } else if (acao == 'i') {
+        // Posiciona no primeiro território filtrado com ID >= N (busca binária)
+        int alvo = atoi(argumento);
+        int inicio = 0, fim = visor->numIndices;
+        while (inicio < fim) {
+            int meio = (inicio + fim) / 2;
+            if (visor->indices[meio] < alvo) inicio = meio + 1; else fim = meio;
+        }
+        visor->topo = inicio;
+    } else if (acao == 'c' || acao == 'p') {
+        if (acao == 'c') {
+            // Nenhuma cor tem mais de TAM_COR - 1 caracteres: um filtro maior é recusado
+            if (strlen(argumento) >= TAM_COR) {
+                snprintf(visor->aviso, sizeof(visor->aviso), " Filtro recusado: a cor tem no maximo %d caracteres.", TAM_COR - 1);
+                return 1;
+            }
+            memcpy(visor->filtroCor, argumento, strlen(argumento) + 1);
+        } else {
+            snprintf(visor->filtroPrefixo, TAM_NOME, "%s", argumento);
+        }
+        aplicarFiltroVisor(visor, mapa, numTerritorios);
+    }
+
+    // Mantém a janela dentro da lista filtrada
+    if (visor->topo > visor->numIndices - areaDados) visor->topo = visor->numIndices - areaDados;
+    if (visor->topo < 0) visor->topo = 0;
+    return 1;
+}
+
+/**
+ * @brief Desenha o visor no terminal, reescrevendo apenas as células alteradas.
+ * Cada linha da tela é montada em memória e comparada com o quadro atual; só o
+ * trecho diferente é enviado, precedido de uma sequência de posicionamento do
+ * cursor. O custo depende do tamanho da janela, e não de numTerritorios.
+ * Layout: título, cabeçalho, territórios, ajuda, linha de comando e uma linha
+ * vazia (para o Enter do jogador não rolar a tela).
+ * @param visor Ponteiro para o visor.
+ * @param mapa Ponteiro constante para o vetor de territórios.
+ * @param numTerritorios O tamanho do vetor.
+ */
+void desenharVisor(Visor* visor, const Territorio* mapa, int numTerritorios) {
+    int colunas = visor->colunas;
+    int areaDados = visor->linhas - 5;
+    char* linha = (char*)malloc(colunas + 1);
+    char* saida = visor->saida;
+    size_t usado = 0;
+    if (linha == NULL) {
+        return;
+    }
+
+    if (!visor->quadroValido) {
+        usado += sprintf(saida + usado, "\033[H\033[2J");
+        memset(visor->quadro, ' ', (size_t)visor->linhas * colunas);
+    }
+
+    for (int r = 0; r < visor->linhas - 2; r++) {
+        // 1. Monta o conteúdo da linha r (sem acentos: 1 byte por coluna)
+        if (r == 0) {
+            int ultimo = visor->topo + areaDados < visor->numIndices ? visor->topo + areaDados : visor->numIndices;
+            snprintf(linha, colunas + 1, " MAPA  %d-%d de %d (total %d)  dono: %s  prefixo: %s",
+                     visor->numIndices > 0 ? visor->topo + 1 : 0, ultimo, visor->numIndices, numTerritorios,
+                     visor->filtroCor[0] ? visor->filtroCor : "*", visor->filtroPrefixo[0] ? visor->filtroPrefixo : "*");
+        } else if (r == 1) {
+            snprintf(linha, colunas + 1, " %-8s %-29s %-9s %8s", "ID", "NOME", "DONO", "TROPAS");
+        } else if (r - 2 < areaDados) {
+            int pos = visor->topo + r - 2;
+            if (pos < visor->numIndices) {
+                const Territorio* t = mapa + visor->indices[pos];
+                snprintf(linha, colunas + 1, " %-8d %-29s %-9s %8d", visor->indices[pos], t->nome, t->cor, t->tropas);
+            } else {
+                linha[0] = '\0';
+            }
+        } else {
+            snprintf(linha, colunas + 1, " [j/k] linha [f/b] pagina [i N] ir [c COR] dono [p TXT] prefixo [q] sair");
+        }
+        size_t tamanho = strlen(linha);
+        memset(linha + tamanho, ' ', colunas - tamanho);
+
+        // 2. Compara com o quadro e envia apenas o trecho alterado
+        char* naTela = visor->quadro + (size_t)r * colunas;
+        int primeira = 0, ultima = colunas - 1;
+        while (primeira < colunas && linha[primeira] == naTela[primeira]) primeira++;
+        if (primeira == colunas && visor->quadroValido) continue;
+        while (ultima > primeira && linha[ultima] == naTela[ultima]) ultima--;
+
+        // Bytes acima de 127 (ex: UTF-8) não têm largura fixa: redesenha a linha toda
+        for (int c = 0; c < colunas; c++) {
+            if ((unsigned char)linha[c] > 127) {
+                primeira = 0;
+                ultima = colunas - 1;
+                break;
+            }
+        }
+        if (primeira < colunas) {
+            usado += sprintf(saida + usado, "\033[%d;%dH", r + 1, primeira + 1);
+            memcpy(saida + usado, linha + primeira, ultima - primeira + 1);
+            usado += ultima - primeira + 1;
+            memcpy(naTela + primeira, linha + primeira, ultima - primeira + 1);
+        }
+    }
+
+    // 3. Linha de status (aviso do último comando, se houver) e linha de comando:
+    // sempre limpas, pois contêm o que o jogador digitou
+    usado += sprintf(saida + usado, "\033[%d;1H\033[2K%.*s\033[%d;1H\033[2KComando: ",
+                     visor->linhas, colunas - 1, visor->aviso, visor->linhas - 1);
+    visor->aviso[0] = '\0';
+    visor->quadroValido = 1;
+
+    fwrite(saida, 1, usado, stdout);
+    fflush(stdout);
+    free(linha);
+}
+
+/**
+ * @brief Corrotina do visor do mapa: desenha a janela e processa comandos até 'q'.
+ * @param partida Ponteiro para a partida.
+ * @return CORROTINA_ESPERANDO enquanto aguarda entrada, CORROTINA_TERMINADA ao sair.
+ */
+int navegarMapa(Partida* partida) {
+    Visor* visor = &partida->visor;
+
+    CORROTINA_INICIO(partida->estadoVisor);
+
+    if (!iniciarVisor(visor, partida->numTerritorios)) {
+        printf("\nERRO: Falha ao alocar memória para o visor do mapa.\n");
+    } else {
+        // O mapa pode ter mudado desde a última visita, e a tela foi usada por outros textos
+        aplicarFiltroVisor(visor, partida->mapa, partida->numTerritorios);
+        visor->quadroValido = 0;
+    }
+
+    while (visor->quadro != NULL) {
+        desenharVisor(visor, partida->mapa, partida->numTerritorios);
+        aguardarEntrada(partida, PEDIDO_VISOR);
+        CORROTINA_ESPERAR(partida->estadoVisor, partida->linhaPronta || partida->fimEntrada);
+        if (!partida->linhaPronta) {
+            break;
+        }
+        partida->pedido = PEDIDO_NENHUM;
+        partida->linhaPronta = 0;
+        if (!executarComandoVisor(visor, partida->linha, partida->mapa, partida->numTerritorios)) {
+            break;
+        }
+    }
+
+    // Devolve o cursor para baixo da janela antes de voltar ao menu
+    if (visor->quadro != NULL) {
+        printf("\033[%d;1H\n", visor->linhas);
+    }
+
+    CORROTINA_FIM(partida->estadoVisor);
+}
+
+// ---------------------- ESTATÍSTICAS ----------------------------------------
+
+/**
+ * @brief Aloca os agregados de uma partida e calcula os totais iniciais por cor.
+ * É o único passo que percorre o mapa inteiro; depois disso, cada batalha
+ * atualiza os contadores em tempo constante.
+ * @param mapa Ponteiro constante para o vetor de territórios da partida.
+ * @param numTerritorios O tamanho do vetor.
+ * @param idPartida Identificador da partida.
+ * @return Os agregados alocados, ou NULL em caso de falha (estatísticas desligadas).
+ */
+Estatisticas* iniciarEstatisticas(const Territorio* mapa, int numTerritorios, int idPartida) {
+    Estatisticas* e = (Estatisticas*)calloc(1, sizeof(Estatisticas));
+    if (e == NULL) {
+        return NULL;
+    }
+    size_t n = numTerritorios > 0 ? (size_t)numTerritorios : 1;
+    e->conquistas = (unsigned int*)calloc(n, sizeof(unsigned int));
+    e->batalhasPosse = (unsigned int*)calloc(n, sizeof(unsigned int));
+    e->inicioPosse = (unsigned int*)calloc(n, sizeof(unsigned int));
+    e->alterado = (unsigned char*)calloc(n, sizeof(unsigned char));
+    e->listaAlterados = (int*)malloc(n * sizeof(int));
+    if (e->conquistas == NULL || e->batalhasPosse == NULL || e->inicioPosse == NULL ||
+        e->alterado == NULL || e->listaAlterados == NULL) {
+        finalizarEstatisticas(e);
+        return NULL;
+    }
+
+    e->ativa = 1;
+    e->idPartida = idPartida;
+    e->mapaBase = mapa;
+    e->numTerritorios = numTerritorios;
+    for (int i = 0; i < numTerritorios; i++) {
+        int c = indiceCor(e, (mapa + i)->cor);
+        e->tropasPorCor[c] += (mapa + i)->tropas;
+        e->territoriosPorCor[c]++;
+    }
+    return e;
+}
+
+/**
+ * @brief Retorna o índice de uma cor na tabela de cores, cadastrando-a se for nova.
+ * Quando a tabela enche, as cores excedentes são agrupadas na última posição.
+ * @param e Ponteiro para os agregados da partida.
+ * @param cor Nome da cor.
+ * @return O índice da cor (0 a MAX_CORES_ESTATISTICAS - 1).
+ */
+int indiceCor(Estatisticas* e, const char* cor) {
+    for (int c = 0; c < e->numCores; c++) {
+        if (strcmp(e->cores[c], cor) == 0) {
+            return c;
+        }
+    }
+    if (e->numCores < MAX_CORES_ESTATISTICAS - 1) {
+        strcpy(e->cores[e->numCores], cor);
+        return e->numCores++;
+    }
+    if (e->numCores == MAX_CORES_ESTATISTICAS - 1) {
+        strcpy(e->cores[e->numCores++], "*outras*");
+    }
+    return MAX_CORES_ESTATISTICAS - 1;
+}
+
+/**
+ * @brief Atualiza os agregados da partida em execução após uma batalha.
+ * Não faz nada se as estatísticas estão desligadas.
+ * @param antesAtacante Cópia do atacante antes da batalha.
+ * @param antesDefensor Cópia do defensor antes da batalha.
+ * @param atacante Ponteiro constante para o atacante após a batalha.
+ * @param defensor Ponteiro constante para o defensor após a batalha.
+ * @param dadoAtacante Dado rolado pelo atacante.
+ * @param dadoDefensor Dado rolado pelo defensor.
+ */
+void registrarBatalha(const Territorio* antesAtacante, const Territorio* antesDefensor,
+                      const Territorio* atacante, const Territorio* defensor,
+                      int dadoAtacante, int dadoDefensor) {
+    Estatisticas* e = estatisticasAtivas;
+    if (e == NULL || !e->ativa) {
+        return;
+    }
+    e->batalha++;
+
+    // 1. Histogramas dos dados
+    e->dadosAtaque[dadoAtacante - 1]++;
+    e->dadosDefesa[dadoDefensor - 1]++;
+    e->pares[dadoAtacante - 1][dadoDefensor - 1]++;
+
+    // 2. Totais por cor: retira o estado anterior e soma o novo
+    const Territorio* antes[2] = { antesAtacante, antesDefensor };
+    const Territorio* depois[2] = { atacante, defensor };
+    for (int k = 0; k < 2; k++) {
+        int c = indiceCor(e, antes[k]->cor);
+        e->tropasPorCor[c] -= antes[k]->tropas;
+        e->territoriosPorCor[c]--;
+        c = indiceCor(e, depois[k]->cor);
+        e->tropasPorCor[c] += depois[k]->tropas;
+        e->territoriosPorCor[c]++;
+    }
+
+    // 3. Conquista: encerra a posse anterior do território
+    if (strcmp(antesDefensor->cor, defensor->cor) != 0) {
+        int id = (int)(defensor - e->mapaBase);
+        e->conquistas[id]++;
+        e->batalhasPosse[id] += e->batalha - e->inicioPosse[id];
+        e->inicioPosse[id] = e->batalha;
+        if (!e->alterado[id]) {
+            e->alterado[id] = 1;
+            e->listaAlterados[e->numAlterados++] = id;
+        }
+    }
+
+    // 4. Série temporal: uma amostra por cor nesta batalha
+    for (int c = 0; c < e->numCores; c++) {
+        e->serie[0][e->numAmostras] = e->batalha;
+        e->serie[1][e->numAmostras] = (unsigned int)c;
+        e->serie[2][e->numAmostras] = (unsigned int)e->tropasPorCor[c];
+        e->serie[3][e->numAmostras] = (unsigned int)e->territoriosPorCor[c];
+        e->numAmostras++;
+    }
+
+    // 5. Descarga periódica (o buffer da série comporta BATALHAS_POR_DESCARGA batalhas)
+    if (e->batalha % BATALHAS_POR_DESCARGA == 0) {
+        descarregarEstatisticas(e);
+    }
+}
+
+/**
+ * @brief Grava o cabeçalho de um bloco no arquivo de estatísticas.
+ * @param tipo Tipo do bloco (BLOCO_*).
+ * @param partida Identificador da partida.
+ * @param batalha Batalhas já travadas na partida no momento da gravação.
+ * @param numLinhas Número de linhas (elementos de cada coluna) do bloco.
+ */
+void gravarBloco(unsigned int tipo, unsigned int partida, unsigned int batalha, unsigned int numLinhas) {
+    unsigned int cabecalho[4] = { tipo, partida, batalha, numLinhas };
+    gravarColuna(cabecalho, sizeof(unsigned int), 4);
+}
+
+/**
+ * @brief Grava uma coluna (ou qualquer trecho) no arquivo de estatísticas.
+ * Uma gravação incompleta é contada em falhasEstatisticas.
+ * @param dados Ponteiro para os elementos a gravar.
+ * @param tamanho Tamanho de cada elemento, em bytes.
+ * @param quantidade Número de elementos.
+ */
+void gravarColuna(const void* dados, size_t tamanho, size_t quantidade) {
+    if (fwrite(dados, tamanho, quantidade, arquivoEstatisticas) != quantidade) {
+        falhasEstatisticas++;
+    }
+}
+
+/**
+ * @brief Grava os agregados acumulados desde a última descarga e zera os contadores.
+ * @param e Ponteiro para os agregados da partida.
+ */
+void descarregarEstatisticas(Estatisticas* e) {
+    if (e == NULL || !e->ativa || arquivoEstatisticas == NULL) {
+        return;
+    }
+    unsigned int idPartida = (unsigned int)e->idPartida;
+
+    // Cores novas desde a última descarga
+    if (e->numCores > e->coresGravadas) {
+        gravarBloco(BLOCO_CORES, idPartida, e->batalha, e->numCores);
+        gravarColuna(e->cores, TAM_COR, e->numCores);
+        e->coresGravadas = e->numCores;
+    }
+
+    // Histogramas dos dados
+    unsigned int faces[6] = { 1, 2, 3, 4, 5, 6 };
+    gravarBloco(BLOCO_DADOS, idPartida, e->batalha, 6);
+    gravarColuna(faces, sizeof(unsigned int), 6);
+    gravarColuna(e->dadosAtaque, sizeof(unsigned int), 6);
+    gravarColuna(e->dadosDefesa, sizeof(unsigned int), 6);
+    gravarColuna(e->pares, sizeof(unsigned int), 36);
+    memset(e->dadosAtaque, 0, sizeof(e->dadosAtaque));
+    memset(e->dadosDefesa, 0, sizeof(e->dadosDefesa));
+    memset(e->pares, 0, sizeof(e->pares));
+
+    // Territórios alterados: cada coluna é montada e gravada de uma vez
+    if (e->numAlterados > 0) {
+        unsigned int* coluna = (unsigned int*)malloc(e->numAlterados * sizeof(unsigned int));
+        if (coluna != NULL) {
+            gravarBloco(BLOCO_TERRITORIOS, idPartida, e->batalha, e->numAlterados);
+            for (int k = 0; k < e->numAlterados; k++) coluna[k] = (unsigned int)e->listaAlterados[k];
+            gravarColuna(coluna, sizeof(unsigned int), e->numAlterados);
+            for (int k = 0; k < e->numAlterados; k++) coluna[k] = e->conquistas[e->listaAlterados[k]];
+            gravarColuna(coluna, sizeof(unsigned int), e->numAlterados);
+            for (int k = 0; k < e->numAlterados; k++) coluna[k] = e->batalhasPosse[e->listaAlterados[k]];
+            gravarColuna(coluna, sizeof(unsigned int), e->numAlterados);
+            free(coluna);
+        } else {
+            falhasEstatisticas++; // Sem memória para a coluna: os territórios deste bloco se perdem
+        }
+        for (int k = 0; k < e->numAlterados; k++) {
+            int id = e->listaAlterados[k];
+            e->conquistas[id] = 0;
+            e->batalhasPosse[id] = 0;
+            e->alterado[id] = 0;
+        }
+        e->numAlterados = 0;
+    }
+
+    // Série temporal
+    if (e->numAmostras > 0) {
+        gravarBloco(BLOCO_SERIE, idPartida, e->batalha, e->numAmostras);
+        for (int col = 0; col < 4; col++) {
+            gravarColuna(e->serie[col], sizeof(unsigned int), e->numAmostras);
+        }
+        e->numAmostras = 0;
+    }
+}
+
+/**
+ * @brief Encerra as estatísticas da partida: fecha a posse ainda aberta de todos
+ * os territórios (inclusive os que nunca mudaram de dono, cuja posse começou na
+ * batalha 0), grava o que falta e libera a memória. Assim, a coluna de posse de
+ * BLOCO_TERRITORIOS soma, ao fim da partida, a duração de todas as posses.
+ * @param e Ponteiro para os agregados da partida (pode ser NULL).
+ */
+void finalizarEstatisticas(Estatisticas* e) {
+    if (e == NULL) {
+        return;
+    }
+    if (e->ativa) {
+        for (int id = 0; id < e->numTerritorios; id++) {
+            e->batalhasPosse[id] += e->batalha - e->inicioPosse[id];
+            if (!e->alterado[id]) {
+                e->alterado[id] = 1;
+                e->listaAlterados[e->numAlterados++] = id;
+            }
+        }
+        descarregarEstatisticas(e);
+    }
+    free(e->conquistas);
+    free(e->batalhasPosse);
+    free(e->inicioPosse);
+    free(e->alterado);
+    free(e->listaAlterados);
+    free(e);
+}
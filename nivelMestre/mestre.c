@@ -2,6 +2,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <errno.h>
+#include <limits.h>
+
+// Instrucoes vetoriais (SSE2) sao usadas quando o compilador as disponibiliza;
+// caso contrario, a verificacao em lote usa apenas o laco escalar.
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // --- Estruturas de Dados ---
 
@@ -12,6 +20,56 @@ typedef struct {
     int tropas;    // Número de tropas no território
 } Territorio;
 
+// Estrutura para um passo do plano de ataque sugerido pelo conselheiro
+typedef struct {
+    int origem;           // Indice do territorio atacante
+    int destino;          // Indice do territorio a ser conquistado
+    double perdaEsperada; // Tropas que o atacante deve perder ate conquistar
+} PassoPlano;
+
+// Candidato a origem de ataque na fila de prioridade do conselheiro
+typedef struct {
+    int tropas;  // Tropas da origem quando foi inserida (chave do heap)
+    int indice;  // Indice do territorio no mapa
+} CandidatoOrigem;
+
+// Texto pre-processado para comparacao rapida com um campo de tamanho fixo
+// (ex: 'cor'), usado pela verificacao em lote no lugar de strcmp.
+typedef struct {
+    char bytes[16];  // Texto seguido de zeros
+    int tamanho;     // Bytes que precisam coincidir (texto + '\0')
+    int mascara;     // Um bit por byte que precisa coincidir
+    int cabe;        // 0 se o texto nao cabe no campo (nunca coincide)
+} PadraoTexto;
+
+// --- Registro de Eventos (log binario compacto) ---
+
+#define TAM_BUFFER_REGISTRO (64 * 1024) // Eventos acumulados em memoria antes de cada fwrite
+#define VERSAO_REGISTRO 2
+
+// Tipos de evento. Cada evento e gravado como o tipo seguido de seus campos,
+// todos codificados como varint (7 bits por byte, bit alto indica continuacao).
+#define EVENTO_SETUP 1      // numTerritorios
+#define EVENTO_TERRITORIO 2 // indice, nome, cor, tropas (strings: tamanho + bytes)
+#define EVENTO_MISSAO 3     // indice da missao sorteada
+#define EVENTO_TURNO 4      // numero do turno
+#define EVENTO_ATAQUE 5     // origem, destino
+#define EVENTO_DADOS 6      // dado do atacante, dado do defensor
+#define EVENTO_CONQUISTA 7  // origem, destino (destino passa para a cor da origem, com 0 tropas)
+#define EVENTO_MOVIMENTO 8  // origem, destino, tropas movidas
+#define EVENTO_PERDA 9      // territorio, tropas perdidas
+#define EVENTO_FIM 10       // total de eventos anteriores (ultimo evento; sem ele o log esta truncado)
+
+// Estrutura que acumula os eventos codificados e os grava em blocos no arquivo
+typedef struct {
+    FILE* arquivo;                                // Arquivo de destino do log
+    unsigned char buffer[TAM_BUFFER_REGISTRO];    // Eventos ainda nao gravados
+    size_t usado;                                 // Bytes ocupados no buffer
+    const Territorio* mapaBase;                   // Inicio do mapa (para converter ponteiros em indices)
+    unsigned long numEventos;                     // Total de eventos registrados
+    unsigned long falhas;                         // Gravacoes incompletas (disco cheio, erro de E/S...)
+} RegistroEventos;
+
 // --- Protótipos das Funções ---
 
 void inicializarJogo(Territorio** mapa, int* numTerritorios, char** missaoJogador);
@@ -22,6 +80,34 @@ void exibirMapa(Territorio* mapa, int tamanho);
 void atacar(Territorio* atacante, Territorio* defensor);
 void liberarMemoria(Territorio* mapa, char* missaoJogador);
 
+// Verificacao de missoes em lote (varios jogos de uma vez)
+int codificarMissao(const char* missao);
+void verificarMissoesEmLote(const char* missoes[], Territorio* mapas, int territoriosPorJogo,
+                            int numJogos, const char* corJogador, int* resultados);
+int autoverificarLote(int numJogos, int territoriosPorJogo);
+void prepararPadrao(PadraoTexto* padrao, const char* texto, int tamanhoCampo);
+int campoIgual(const char* campo, const PadraoTexto* padrao, const char* limite);
+
+// Conselheiro estrategico (plano minimo de ataques para cumprir a missao)
+void calcularResultadoEsperado(int tropasAtacante, double* perdaEsperada, double* tropasMovidas);
+double aplicarResultadoEsperado(int tropasAtacante, int* restantes, int* transferidas);
+int origemViavel(int idMissao, int tropas);
+void inserirCandidato(CandidatoOrigem* heap, int* tamanhoHeap, CandidatoOrigem candidato);
+CandidatoOrigem removerCandidato(CandidatoOrigem* heap, int* tamanhoHeap);
+int planejarMissao(const char* missao, const Territorio* mapa, int tamanho, const char* corJogador,
+                   PassoPlano* plano, int maxPassos);
+void exibirPlano(const PassoPlano* plano, int numPassos, const Territorio* mapa);
+
+// Registro de eventos e reproducao deterministica
+RegistroEventos* abrirRegistro(const char* caminho, unsigned int semente);
+int fecharRegistro(RegistroEventos* registro);
+void descarregarRegistro(RegistroEventos* registro);
+void escreverVarint(RegistroEventos* registro, unsigned int valor);
+void registrarEvento(int tipo, unsigned int a, unsigned int b, unsigned int c);
+void registrarTerritorio(int indice, const Territorio* t);
+int lerVarint(const unsigned char** cursor, const unsigned char* fim, unsigned int* valor);
+int reproduzirRegistro(const char* caminho, int turnoAlvo);
+
 // --- Implementação das Missões Pré-Definidas ---
 
 #define MAX_MISSOES 5
@@ -33,13 +119,84 @@ char* MISSOES[] = {
     "Missao E: Conquistar 10 territorios no total."       // Condicao: 10 territorios com a cor do jogador
 };
 
+// Identificadores numericos das missoes, na mesma ordem do vetor MISSOES.
+// Usados pela verificacao em lote para evitar comparar strings a cada jogo.
+#define MISSAO_DESCONHECIDA -1
+#define MISSAO_A 0
+#define MISSAO_B 1
+#define MISSAO_C 2
+#define MISSAO_D 3
+#define MISSAO_E 4
+
 // A cor do jogador para quem a missao sera sorteada (simplificacao)
 #define COR_JOGADOR "Verde"
 
+// Registro de eventos da partida em andamento (NULL quando o log esta desligado)
+RegistroEventos* registroJogo = NULL;
+
+// Numero de campos de cada tipo de evento (EVENTO_TERRITORIO e gravado a parte)
+const int CAMPOS_EVENTO[] = { 0, 1, 0, 1, 1, 2, 2, 2, 3, 2, 1 };
+
 // --- Função Principal (main) ---
-int main() {
+int main(int argc, char* argv[]) {
+    // Opcoes de linha de comando:
+    //   --log arquivo         grava todos os eventos da partida no arquivo
+    //   --semente N           usa a semente N no gerador de numeros aleatorios
+    //   --replay arquivo [T]  reconstroi a partida do log ate o fim do turno T
+    //   --verificar-lote N    confere a verificacao em lote contra a jogo a jogo em N jogos
+    unsigned int semente = (unsigned int)time(NULL);
+    const char* caminhoLog = NULL;
+    int jogosAutoverificacao = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            caminhoLog = argv[++i];
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            const char* caminho = argv[++i];
+            int turnoAlvo = -1;
+            // O turno e opcional: o argumento seguinte so e consumido se nao for outra opcao
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+                char* fimNumero;
+                errno = 0;
+                long valor = strtol(argv[i + 1], &fimNumero, 10);
+                if (fimNumero == argv[i + 1] || *fimNumero != '\0' || errno == ERANGE ||
+                    valor < 0 || valor > INT_MAX) {
+                    fprintf(stderr, "Erro: turno invalido para --replay: '%s' (use um inteiro >= 0).\n", argv[i + 1]);
+                    return 1;
+                }
+                turnoAlvo = (int)valor;
+                i++;
+            }
+            return reproduzirRegistro(caminho, turnoAlvo) ? 0 : 1;
+        } else if (strcmp(argv[i], "--verificar-lote") == 0 && i + 1 < argc) {
+            char* fimNumero;
+            errno = 0;
+            long valor = strtol(argv[++i], &fimNumero, 10);
+            if (fimNumero == argv[i] || *fimNumero != '\0' || errno == ERANGE || valor < 1 || valor > 1000000) {
+                fprintf(stderr, "Erro: numero de jogos invalido para --verificar-lote: '%s' (use 1 a 1000000).\n", argv[i]);
+                return 1;
+            }
+            jogosAutoverificacao = (int)valor;
+        }
+    }
+
+    // Autoverificacao da verificacao em lote (jogos com 42 territorios, como no WAR)
+    if (jogosAutoverificacao > 0) {
+        srand(semente);
+        return autoverificarLote(jogosAutoverificacao, 42) ? 0 : 1;
+    }
+
     // Inicializa a semente para a geracao de numeros aleatorios
-    srand(time(NULL));
+    srand(semente);
+
+    if (caminhoLog != NULL) {
+        registroJogo = abrirRegistro(caminhoLog, semente);
+        if (registroJogo == NULL) {
+            perror("Erro ao abrir o arquivo de log");
+            return 1;
+        }
+    }
 
     // Ponteiros para alocacao dinamica
     Territorio* mapa = NULL;
@@ -55,9 +212,18 @@ int main() {
     // Exibicao da missao (Passagem por valor, pois 'missaoJogador' e const)
     exibirMissao(missaoJogador);
 
+    // Dica do conselheiro: sequencia de ataques sugerida (gulosa) para cumprir a missao
+    PassoPlano* plano = (PassoPlano*)malloc(numTerritorios * sizeof(PassoPlano));
+    if (plano != NULL) {
+        int numPassos = planejarMissao(missaoJogador, mapa, numTerritorios, COR_JOGADOR, plano, numTerritorios);
+        exibirPlano(plano, numPassos, mapa);
+        free(plano);
+    }
+
     // Loop principal do jogo (Simulacao de turnos)
     for (int turno = 1; turno <= 3; turno++) {
         printf("\n\n=============== TURNO %d ==============\n", turno);
+        registrarEvento(EVENTO_TURNO, turno, 0, 0);
         exibirMapa(mapa, numTerritorios);
 
         // --- Simulacao de Acoes ---
@@ -78,12 +244,14 @@ int main() {
         }
     }
 
-    // Libera toda a memoria alocada dinamicamente
+    // Grava os eventos restantes do log e libera toda a memoria alocada dinamicamente
+    int logGravado = fecharRegistro(registroJogo);
+    registroJogo = NULL;
     liberarMemoria(mapa, missaoJogador);
 
     printf("\nJogo finalizado. Memoria liberada.\n");
 
-    return 0;
+    return logGravado ? 0 : 1;
 }
 
 // --- Funções Auxiliares ---
@@ -125,6 +293,15 @@ void inicializarJogo(Territorio** mapa, int* numTerritorios, char** missaoJogado
     strcpy((*mapa + 3)->cor, COR_JOGADOR);
     (*mapa + 3)->tropas = 4;
 
+    // Registra o mapa inicial no log (se ativo)
+    if (registroJogo != NULL) {
+        registroJogo->mapaBase = *mapa;
+        registrarEvento(EVENTO_SETUP, *numTerritorios, 0, 0);
+        for (int i = 0; i < *numTerritorios; i++) {
+            registrarTerritorio(i, (*mapa + i));
+        }
+    }
+
     // 2. Alocacao dinamica da missao do jogador (Tamanho da maior missao + 1 para '\0')
     int maxLen = 0;
     for (int i = 0; i < MAX_MISSOES; i++) {
@@ -152,6 +329,7 @@ void inicializarJogo(Territorio** mapa, int* numTerritorios, char** missaoJogado
  */
 void atribuirMissao(char* destino, char* missoes[], int totalMissoes) {
     int indiceSorteado = rand() % totalMissoes;
+    registrarEvento(EVENTO_MISSAO, indiceSorteado, 0, 0);
     // Copia a string da missao para o espaco de memoria alocado dinamicamente
     strcpy(destino, missoes[indiceSorteado]);
 }
@@ -220,6 +398,494 @@ int verificarMissao(const char* missao, Territorio* mapa, int tamanho, const cha
     return 0; // Missao desconhecida ou nao cumprida
 }
 
+/**
+ * @brief Converte a string da missao em seu identificador numerico.
+ * Segue exatamente a mesma ordem de testes de verificarMissao(), para que
+ * as duas formas de verificacao cheguem sempre ao mesmo resultado.
+ * @param missao Ponteiro constante para a string da missao.
+ * @return MISSAO_A..MISSAO_E, ou MISSAO_DESCONHECIDA.
+ */
+int codificarMissao(const char* missao) {
+    if (strstr(missao, "Missao A:") != NULL) return MISSAO_A;
+    if (strstr(missao, "Missao B:") != NULL) return MISSAO_B;
+    if (strstr(missao, "Missao C:") != NULL) return MISSAO_C;
+    if (strstr(missao, "Missao D:") != NULL) return MISSAO_D;
+    if (strstr(missao, "Missao E:") != NULL) return MISSAO_E;
+    return MISSAO_DESCONHECIDA;
+}
+
+/**
+ * @brief Prepara um texto para ser comparado com campos de tamanho fixo.
+ * @param padrao Ponteiro para o padrao a ser preenchido.
+ * @param texto Texto procurado (ex: a cor do jogador).
+ * @param tamanhoCampo Tamanho do campo da struct (ex: sizeof(t->cor)).
+ */
+void prepararPadrao(PadraoTexto* padrao, const char* texto, int tamanhoCampo) {
+    size_t n = strlen(texto);
+    memset(padrao->bytes, 0, sizeof(padrao->bytes));
+    padrao->cabe = (n < (size_t)tamanhoCampo && n < sizeof(padrao->bytes));
+    padrao->tamanho = padrao->cabe ? (int)n + 1 : 0;
+    padrao->mascara = (1 << padrao->tamanho) - 1;
+    if (padrao->cabe) {
+        memcpy(padrao->bytes, texto, n);
+    }
+}
+
+/**
+ * @brief Equivale a strcmp(campo, texto) == 0: compara apenas o texto e seu '\0',
+ * ignorando o lixo que pode haver depois do '\0' no campo.
+ * Com SSE2, compara 16 bytes de uma vez (_mm_cmpeq_epi8) e confere so os bits
+ * da mascara; a leitura de 16 bytes pode passar do fim do campo, entao so e
+ * feita se nao ultrapassar 'limite'.
+ * @param campo Inicio do campo de texto na struct.
+ * @param padrao Ponteiro constante para o padrao preparado por prepararPadrao().
+ * @param limite Fim da memoria que pode ser lida com seguranca.
+ * @return 1 se o campo contem exatamente o texto, 0 caso contrario.
+ */
+int campoIgual(const char* campo, const PadraoTexto* padrao, const char* limite) {
+    if (!padrao->cabe) {
+        return 0;
+    }
+#ifdef __SSE2__
+    if (limite - campo >= 16) {
+        __m128i valores = _mm_loadu_si128((const __m128i*)campo);
+        __m128i esperado = _mm_loadu_si128((const __m128i*)padrao->bytes);
+        int iguais = _mm_movemask_epi8(_mm_cmpeq_epi8(valores, esperado));
+        return (iguais & padrao->mascara) == padrao->mascara;
+    }
+#else
+    (void)limite;
+#endif
+    return memcmp(campo, padrao->bytes, padrao->tamanho) == 0;
+}
+
+/**
+ * @brief Verifica as missoes de varios jogos de uma so vez.
+ * Os mapas dos jogos ficam contiguos na memoria: o jogo j ocupa as posicoes
+ * [j * territoriosPorJogo, (j + 1) * territoriosPorJogo) de 'mapas'.
+ * Cada missao e decodificada uma unica vez. Os textos procurados (cor do
+ * jogador, "Azul", "Canada") sao preparados uma vez por lote, e cada campo e
+ * comparado com uma unica instrucao vetorial em campoIgual(), sem strcmp.
+ * Os contadores somam os predicados (0/1) na mesma passada, sem desvios.
+ * O resultado e identico ao de verificarMissao() jogo a jogo (confira com
+ * a opcao --verificar-lote, que tambem mede o tempo das duas formas).
+ * @param missoes Vetor com a missao de cada jogo (numJogos elementos).
+ * @param mapas Vetor contiguo com os territorios de todos os jogos.
+ * @param territoriosPorJogo Numero de territorios em cada jogo.
+ * @param numJogos Numero de jogos no lote.
+ * @param corJogador Cor do jogador cuja missao esta sendo verificada.
+ * @param resultados Vetor de saida (numJogos elementos): 1 se cumprida, 0 caso contrario.
+ */
+void verificarMissoesEmLote(const char* missoes[], Territorio* mapas, int territoriosPorJogo,
+                            int numJogos, const char* corJogador, int* resultados) {
+    // Textos procurados, preparados uma vez para todo o lote
+    PadraoTexto padraoJogador, padraoAzul, padraoCanada;
+    prepararPadrao(&padraoJogador, corJogador, sizeof(mapas->cor));
+    prepararPadrao(&padraoAzul, "Azul", sizeof(mapas->cor));
+    prepararPadrao(&padraoCanada, "Canada", sizeof(mapas->nome));
+    const char* limite = (const char*)(mapas + (size_t)numJogos * territoriosPorJogo);
+
+    for (int j = 0; j < numJogos; j++) {
+        Territorio* mapa = mapas + (size_t)j * territoriosPorJogo;
+        int idMissao = codificarMissao(missoes[j]);
+        int territoriosDoJogador = 0;
+        int territoriosCom4Tropas = 0;
+        int corAzulEliminada = 1;
+        int canadaConquistado = 0;
+
+        if (idMissao == MISSAO_DESCONHECIDA) {
+            resultados[j] = 0;
+            continue;
+        }
+
+        // 1. Classifica cada territorio (uma comparacao vetorial por campo)
+        if (idMissao == MISSAO_B) {
+            for (int i = 0; i < territoriosPorJogo && corAzulEliminada; i++) {
+                corAzulEliminada = !campoIgual((mapa + i)->cor, &padraoAzul, limite);
+            }
+        } else {
+            for (int i = 0; i < territoriosPorJogo; i++) {
+                Territorio* t = (mapa + i);
+                int ehDoJogador = campoIgual(t->cor, &padraoJogador, limite);
+                territoriosDoJogador += ehDoJogador;
+                territoriosCom4Tropas += ehDoJogador & (t->tropas >= 4);
+
+                // Apenas a missao D precisa deste teste adicional
+                if (idMissao == MISSAO_D && ehDoJogador && campoIgual(t->nome, &padraoCanada, limite)) {
+                    canadaConquistado = 1;
+                }
+            }
+        }
+
+        // 2. Condicao de vitoria a partir dos contadores
+        switch (idMissao) {
+            case MISSAO_A:
+                resultados[j] = (territoriosDoJogador >= 3);
+                break;
+            case MISSAO_B:
+                resultados[j] = corAzulEliminada;
+                break;
+            case MISSAO_C:
+                resultados[j] = (territoriosCom4Tropas >= 5);
+                break;
+            case MISSAO_D:
+                resultados[j] = canadaConquistado;
+                break;
+            case MISSAO_E:
+                resultados[j] = (territoriosDoJogador >= 10);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Autoverificacao da verificacao em lote: sorteia jogos aleatorios,
+ * confere verificarMissoesEmLote() contra verificarMissao() jogo a jogo e
+ * mede o tempo das duas formas.
+ * Os campos de texto sao preenchidos com lixo antes do '\0', como pode
+ * acontecer em um mapa real, para exercitar a comparacao com mascara.
+ * @param numJogos Numero de jogos sorteados.
+ * @param territoriosPorJogo Numero de territorios em cada jogo.
+ * @return 1 se as duas formas concordam em todos os jogos, 0 caso contrario.
+ */
+int autoverificarLote(int numJogos, int territoriosPorJogo) {
+    const char* nomes[] = { "Brasil", "Argentina", "Canada", "Peru", "Chile", "Mexico" };
+    const char* cores[] = { COR_JOGADOR, "Vermelho", "Azul", "Amarelo" };
+    Territorio* mapas = (Territorio*)malloc((size_t)numJogos * territoriosPorJogo * sizeof(Territorio));
+    const char** missoes = (const char**)malloc(numJogos * sizeof(const char*));
+    int* emLote = (int*)malloc(numJogos * sizeof(int));
+    int* jogoAJogo = (int*)malloc(numJogos * sizeof(int));
+    if (mapas == NULL || missoes == NULL || emLote == NULL || jogoAJogo == NULL) {
+        printf("Erro: memoria insuficiente para a autoverificacao.\n");
+        free(mapas);
+        free(missoes);
+        free(emLote);
+        free(jogoAJogo);
+        return 0;
+    }
+
+    // 1. Sorteia os jogos
+    for (int j = 0; j < numJogos; j++) {
+        missoes[j] = MISSOES[rand() % MAX_MISSOES];
+        for (int i = 0; i < territoriosPorJogo; i++) {
+            Territorio* t = mapas + (size_t)j * territoriosPorJogo + i;
+            memset(t->nome, 'x', sizeof(t->nome));
+            memset(t->cor, 'x', sizeof(t->cor));
+            strcpy(t->nome, nomes[rand() % 6]);
+            strcpy(t->cor, cores[rand() % 4]);
+            t->tropas = rand() % 8;
+        }
+    }
+
+    // 2. Verifica nas duas formas, medindo o tempo
+    clock_t inicio = clock();
+    verificarMissoesEmLote(missoes, mapas, territoriosPorJogo, numJogos, COR_JOGADOR, emLote);
+    double tempoLote = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+
+    inicio = clock();
+    for (int j = 0; j < numJogos; j++) {
+        jogoAJogo[j] = verificarMissao(missoes[j], mapas + (size_t)j * territoriosPorJogo,
+                                       territoriosPorJogo, COR_JOGADOR);
+    }
+    double tempoJogoAJogo = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+
+    // 3. Compara os resultados
+    int divergencias = 0;
+    int cumpridas = 0;
+    for (int j = 0; j < numJogos; j++) {
+        if (emLote[j] != jogoAJogo[j]) {
+            if (divergencias < 10) {
+                printf("Divergencia no jogo %d (%s): lote %d, jogo a jogo %d.\n", j, missoes[j], emLote[j], jogoAJogo[j]);
+            }
+            divergencias++;
+        }
+        cumpridas += jogoAJogo[j];
+    }
+    printf("Verificacao em lote: %d jogos x %d territorios, %d missoes cumpridas.\n", numJogos, territoriosPorJogo, cumpridas);
+    printf("Tempo em lote: %.3f s | jogo a jogo: %.3f s | divergencias: %d\n", tempoLote, tempoJogoAJogo, divergencias);
+
+    free(mapas);
+    free(missoes);
+    free(emLote);
+    free(jogoAJogo);
+    return divergencias == 0;
+}
+
+/**
+ * @brief Calcula, com as probabilidades exatas dos dados, o resultado esperado
+ * de atacar repetidamente ate conquistar o defensor (regras de atacar()).
+ * Cada rodada o atacante vence com probabilidade 15/36 (dado maior); ao perder,
+ * cede 1 tropa, mas nunca fica com menos de 1. Ao vencer, move metade das tropas.
+ * @param tropasAtacante Tropas do atacante antes da primeira rodada.
+ * @param perdaEsperada Saida: numero esperado de tropas perdidas pelo atacante.
+ * @param tropasMovidas Saida: numero esperado de tropas movidas para o conquistado.
+ */
+void calcularResultadoEsperado(int tropasAtacante, double* perdaEsperada, double* tropasMovidas) {
+    // Probabilidade exata de vitoria do atacante em uma rodada (enumeracao dos 36 pares de dados)
+    int vitorias = 0;
+    for (int a = 1; a <= 6; a++) {
+        for (int d = 1; d <= 6; d++) {
+            if (a > d) vitorias++;
+        }
+    }
+    double p = vitorias / 36.0;
+    double q = 1.0 - p;
+
+    // Distribuicao do numero de derrotas k antes da conquista:
+    // P(k) = q^k * p para k < tropas - 1; ao chegar em 1 tropa nao ha mais perdas,
+    // entao toda a probabilidade restante, q^(tropas - 1), fica em k = tropas - 1.
+    double perda = 0.0, movidas = 0.0, qk = 1.0;
+    int maxPerdas = tropasAtacante > 1 ? tropasAtacante - 1 : 0;
+    int k = 0;
+    for (; k < maxPerdas && qk > 1e-15; k++) {
+        double prob = qk * p;
+        perda += prob * k;
+        movidas += prob * ((tropasAtacante - k) / 2);
+        qk *= q;
+    }
+    // Probabilidade restante (desprezivel se o laco parou antes de maxPerdas)
+    perda += qk * k;
+    movidas += qk * ((tropasAtacante - k) / 2);
+
+    *perdaEsperada = perda;
+    *tropasMovidas = movidas;
+}
+
+/**
+ * @brief Insere um candidato a origem na fila de prioridade (heap minimo por tropas).
+ * @param heap Vetor que armazena o heap.
+ * @param tamanhoHeap Ponteiro para o numero de elementos no heap (atualizado).
+ * @param candidato Candidato a ser inserido.
+ */
+void inserirCandidato(CandidatoOrigem* heap, int* tamanhoHeap, CandidatoOrigem candidato) {
+    int i = (*tamanhoHeap)++;
+    while (i > 0 && (heap + (i - 1) / 2)->tropas > candidato.tropas) {
+        *(heap + i) = *(heap + (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    *(heap + i) = candidato;
+}
+
+/**
+ * @brief Remove e retorna o candidato com menos tropas da fila de prioridade.
+ * @param heap Vetor que armazena o heap (nao pode estar vazio).
+ * @param tamanhoHeap Ponteiro para o numero de elementos no heap (atualizado).
+ * @return O candidato com menos tropas.
+ */
+CandidatoOrigem removerCandidato(CandidatoOrigem* heap, int* tamanhoHeap) {
+    CandidatoOrigem topo = *heap;
+    CandidatoOrigem ultimo = *(heap + --(*tamanhoHeap));
+    int i = 0;
+    while (2 * i + 1 < *tamanhoHeap) {
+        int filho = 2 * i + 1;
+        if (filho + 1 < *tamanhoHeap && (heap + filho + 1)->tropas < (heap + filho)->tropas) {
+            filho++;
+        }
+        if ((heap + filho)->tropas >= ultimo.tropas) break;
+        *(heap + i) = *(heap + filho);
+        i = filho;
+    }
+    if (*tamanhoHeap > 0) {
+        *(heap + i) = ultimo;
+    }
+    return topo;
+}
+
+/**
+ * @brief Calcula as tropas que ficam na origem e as que sao transferidas ao
+ * conquistado, aplicando a perda esperada (arredondada) de um ataque.
+ * @param tropasAtacante Tropas da origem antes do ataque.
+ * @param restantes Saida: tropas da origem apos a conquista.
+ * @param transferidas Saida: tropas movidas para o territorio conquistado.
+ * @return A perda esperada do ataque.
+ */
+double aplicarResultadoEsperado(int tropasAtacante, int* restantes, int* transferidas) {
+    double perda, movidas;
+    calcularResultadoEsperado(tropasAtacante, &perda, &movidas);
+    int sobrevivem = tropasAtacante - (int)(perda + 0.5);
+    *transferidas = sobrevivem / 2;
+    *restantes = sobrevivem - *transferidas;
+    return perda;
+}
+
+/**
+ * @brief Indica se um territorio com essas tropas pode ser origem de um ataque
+ * que faz a missao progredir (poda do conselheiro).
+ * @param idMissao Identificador da missao (MISSAO_A..MISSAO_E).
+ * @param tropas Tropas do territorio de origem.
+ * @return 1 se a origem e viavel, 0 caso contrario.
+ */
+int origemViavel(int idMissao, int tropas) {
+    int restantes, transferidas;
+    if (tropas < 2) return 0;
+    // A perda esperada nunca passa de 21/15 = 1.4 tropas: com 10 ou mais tropas
+    // sobram pelo menos 9, e tanto a origem quanto o conquistado ficam com 4 ou mais.
+    if (tropas >= 10) return 1;
+    aplicarResultadoEsperado(tropas, &restantes, &transferidas);
+    // O territorio conquistado precisa receber tropas
+    if (transferidas < 1) return 0;
+    // Missao C: o conquistado precisa contar para o objetivo e a origem nao pode deixar de contar
+    if (idMissao == MISSAO_C && (transferidas < 4 || (tropas >= 4 && restantes < 4))) return 0;
+    return 1;
+}
+
+/**
+ * @brief Conselheiro estrategico: sugere uma sequencia de ataques que cumpre a
+ * missao do jogador, com heuristica gulosa.
+ * A cada passo, entre os ataques que fazem a missao progredir, escolhe o de
+ * menor perda esperada e aplica seu resultado esperado em uma copia do mapa.
+ * Como a perda esperada cresce com as tropas do atacante, a origem escolhida e
+ * a de menos tropas que passa pela poda, mantida em um heap. A escolha e
+ * apenas local: o plano e viavel, mas nao necessariamente o de menor perda
+ * total (gastar agora um atacante barato pode encarecer os passos seguintes). Os contadores da missao sao atualizados a cada passo, entao o
+ * plano custa O(tamanho + passos * log(tamanho)).
+ * Como qualquer territorio pode atacar qualquer outro, o "caminho" ate um
+ * alvo (ex: 'Canada') tem sempre um unico ataque.
+ * @param missao Ponteiro constante para a string da missao.
+ * @param mapa Ponteiro constante para o vetor de territorios (nao e modificado).
+ * @param tamanho Tamanho do mapa.
+ * @param corJogador Cor do jogador que recebe a dica.
+ * @param plano Vetor de saida com os passos do plano.
+ * @param maxPassos Capacidade do vetor 'plano'.
+ * @return Numero de passos (0 se a missao ja esta cumprida), ou -1 se nao ha plano possivel.
+ */
+int planejarMissao(const char* missao, const Territorio* mapa, int tamanho, const char* corJogador,
+                   PassoPlano* plano, int maxPassos) {
+    int idMissao = codificarMissao(missao);
+    if (idMissao == MISSAO_DESCONHECIDA) {
+        return -1;
+    }
+
+    // Copia do mapa onde os resultados esperados sao aplicados, e heap de origens
+    // (cada passo insere no maximo 2 candidatos)
+    Territorio* simulado = (Territorio*)malloc((tamanho > 0 ? tamanho : 1) * sizeof(Territorio));
+    CandidatoOrigem* heap = (CandidatoOrigem*)malloc((tamanho + 2 * (size_t)maxPassos + 1) * sizeof(CandidatoOrigem));
+    if (simulado == NULL || heap == NULL) {
+        free(simulado);
+        free(heap);
+        return -1;
+    }
+    memcpy(simulado, mapa, tamanho * sizeof(Territorio));
+
+    // 1. Contadores da missao (mesmos de verificarMissao) e origens iniciais
+    int territoriosDoJogador = 0, territoriosCom4Tropas = 0, territoriosAzuis = 0, canadaConquistado = 0;
+    int tamanhoHeap = 0;
+    for (int i = 0; i < tamanho; i++) {
+        Territorio* t = (simulado + i);
+        if (strcmp(t->cor, corJogador) == 0) {
+            territoriosDoJogador++;
+            if (t->tropas >= 4) territoriosCom4Tropas++;
+            if (strcmp(t->nome, "Canada") == 0) canadaConquistado = 1;
+            if (origemViavel(idMissao, t->tropas)) {
+                CandidatoOrigem c = { t->tropas, i };
+                inserirCandidato(heap, &tamanhoHeap, c);
+            }
+        }
+        if (strcmp(t->cor, "Azul") == 0) territoriosAzuis++;
+    }
+
+    int numPassos = 0;
+    int proximoAlvo = 0; // Territorios ja conquistados na copia nao voltam a ser alvos
+    while (1) {
+        int cumprida = 0;
+        switch (idMissao) {
+            case MISSAO_A: cumprida = (territoriosDoJogador >= 3); break;
+            case MISSAO_B: cumprida = (territoriosAzuis == 0); break;
+            case MISSAO_C: cumprida = (territoriosCom4Tropas >= 5); break;
+            case MISSAO_D: cumprida = canadaConquistado; break;
+            case MISSAO_E: cumprida = (territoriosDoJogador >= 10); break;
+        }
+        if (cumprida) break;
+
+        // 2. Alvo: o proximo territorio inimigo que faz a missao progredir
+        int destino = -1;
+        for (; proximoAlvo < tamanho && destino < 0; proximoAlvo++) {
+            Territorio* t = (simulado + proximoAlvo);
+            if (strcmp(t->cor, corJogador) == 0) continue;
+            if (idMissao == MISSAO_B && strcmp(t->cor, "Azul") != 0) continue;
+            if (idMissao == MISSAO_D && strcmp(t->nome, "Canada") != 0) continue;
+            destino = proximoAlvo;
+        }
+
+        // 3. Origem: o candidato com menos tropas (descarta entradas desatualizadas)
+        int origem = -1;
+        while (destino >= 0 && origem < 0 && tamanhoHeap > 0) {
+            CandidatoOrigem c = removerCandidato(heap, &tamanhoHeap);
+            if ((simulado + c.indice)->tropas == c.tropas) {
+                origem = c.indice;
+            }
+        }
+
+        if (origem < 0 || numPassos >= maxPassos) {
+            free(simulado);
+            free(heap);
+            return -1; // Nenhum ataque faz a missao progredir
+        }
+
+        // 4. Aplica o resultado esperado na copia do mapa e atualiza os contadores
+        Territorio* atacante = (simulado + origem);
+        Territorio* defensor = (simulado + destino);
+        int restantes, transferidas;
+        double perda = aplicarResultadoEsperado(atacante->tropas, &restantes, &transferidas);
+
+        if (atacante->tropas >= 4 && restantes < 4) territoriosCom4Tropas--;
+        if (strcmp(defensor->cor, "Azul") == 0) territoriosAzuis--;
+        if (strcmp(defensor->nome, "Canada") == 0) canadaConquistado = 1;
+        if (transferidas >= 4) territoriosCom4Tropas++;
+        territoriosDoJogador++;
+
+        strcpy(defensor->cor, atacante->cor);
+        defensor->tropas = transferidas;
+        atacante->tropas = restantes;
+
+        if (origemViavel(idMissao, atacante->tropas)) {
+            CandidatoOrigem c = { atacante->tropas, origem };
+            inserirCandidato(heap, &tamanhoHeap, c);
+        }
+        if (origemViavel(idMissao, defensor->tropas)) {
+            CandidatoOrigem c = { defensor->tropas, destino };
+            inserirCandidato(heap, &tamanhoHeap, c);
+        }
+
+        (plano + numPassos)->origem = origem;
+        (plano + numPassos)->destino = destino;
+        (plano + numPassos)->perdaEsperada = perda;
+        numPassos++;
+    }
+
+    // Confirma o plano com a verificacao oficial da missao
+    int valido = verificarMissao(missao, simulado, tamanho, corJogador);
+    free(simulado);
+    free(heap);
+    return valido ? numPassos : -1;
+}
+
+/**
+ * @brief Exibe o plano de ataques sugerido pelo conselheiro.
+ * @param plano Ponteiro constante para os passos do plano.
+ * @param numPassos Numero de passos (ou -1 se nao ha plano).
+ * @param mapa Ponteiro constante para o mapa atual (nomes dos territorios).
+ */
+void exibirPlano(const PassoPlano* plano, int numPassos, const Territorio* mapa) {
+    printf("\n-------------- DICA DO CONSELHEIRO --------------\n");
+    if (numPassos < 0) {
+        printf("| Nenhuma sequencia de ataques cumpre a missao agora.\n");
+    } else if (numPassos == 0) {
+        printf("| A missao ja esta cumprida!\n");
+    } else {
+        double perdaTotal = 0.0;
+        for (int i = 0; i < numPassos; i++) {
+            const PassoPlano* passo = (plano + i);
+            printf("| %d. %s ataca %s (perda esperada: %.2f tropas)\n", i + 1,
+                   (mapa + passo->origem)->nome, (mapa + passo->destino)->nome, passo->perdaEsperada);
+            perdaTotal += passo->perdaEsperada;
+        }
+        printf("| Perda total esperada: %.2f tropas\n", perdaTotal);
+        printf("| (plano guloso: viavel, mas nao necessariamente o de menor perda)\n");
+    }
+    printf("-------------------------------------------------\n");
+}
+
 /**
  * @brief Exibe o estado atual de cada territorio no mapa.
  * @param mapa Ponteiro para o vetor de territorios.
@@ -251,6 +917,15 @@ void atacar(Territorio* atacante, Territorio* defensor) {
     int dadoAtacante = (rand() % 6) + 1;
     int dadoDefensor = (rand() % 6) + 1;
 
+    // Indices dos territorios no mapa, usados pelo log de eventos
+    unsigned int idAtacante = 0, idDefensor = 0;
+    if (registroJogo != NULL) {
+        idAtacante = (unsigned int)(atacante - registroJogo->mapaBase);
+        idDefensor = (unsigned int)(defensor - registroJogo->mapaBase);
+    }
+    registrarEvento(EVENTO_ATAQUE, idAtacante, idDefensor, 0);
+    registrarEvento(EVENTO_DADOS, dadoAtacante, dadoDefensor, 0);
+
     printf("%s (%s, %d tropas) ataca %s (%s, %d tropas).\n",
            atacante->nome, atacante->cor, atacante->tropas,
            defensor->nome, defensor->cor, defensor->tropas);
@@ -265,14 +940,18 @@ void atacar(Territorio* atacante, Territorio* defensor) {
         int tropasTransferidas = atacante->tropas / 2;
         defensor->tropas = tropasTransferidas;
         atacante->tropas -= tropasTransferidas;
+        registrarEvento(EVENTO_CONQUISTA, idAtacante, idDefensor, 0);
+        registrarEvento(EVENTO_MOVIMENTO, idAtacante, idDefensor, tropasTransferidas);
     } else {
         // Defensor vence ou empate
         printf("Defensor RESISTE! %s perde 1 tropa.\n", atacante->nome);
+        int tropasAntes = atacante->tropas;
         atacante->tropas -= 1;
         // Garante que o numero de tropas nao fique negativo
         if (atacante->tropas < 1) {
             atacante->tropas = 1; // Um territorio precisa de pelo menos 1 tropa
         }
+        registrarEvento(EVENTO_PERDA, idAtacante, tropasAntes - atacante->tropas, 0);
     }
 }
 
@@ -290,4 +969,347 @@ void liberarMemoria(Territorio* mapa, char* missaoJogador) {
         free(missaoJogador);
         printf("Memoria da missao liberada.\n");
     }
-}
\ No newline at end of file
+}
+
+// --- Registro de Eventos e Reproducao ---
+
+/**
+ * @brief Cria o arquivo de log e grava o cabecalho ("WARL", versao e semente).
+ * @param caminho Caminho do arquivo de log.
+ * @param semente Semente usada em srand(), necessaria para a reproducao.
+ * @return Ponteiro para o registro alocado, ou NULL em caso de falha.
+ */
+RegistroEventos* abrirRegistro(const char* caminho, unsigned int semente) {
+    RegistroEventos* registro = (RegistroEventos*)calloc(1, sizeof(RegistroEventos));
+    if (registro == NULL) {
+        return NULL;
+    }
+    registro->arquivo = fopen(caminho, "wb");
+    if (registro->arquivo == NULL) {
+        free(registro);
+        return NULL;
+    }
+    memcpy(registro->buffer, "WARL", 4);
+    registro->usado = 4;
+    escreverVarint(registro, VERSAO_REGISTRO);
+    escreverVarint(registro, semente);
+    return registro;
+}
+
+/**
+ * @brief Grava no arquivo os eventos acumulados no buffer (um unico fwrite).
+ * Uma gravacao incompleta e contada em registro->falhas.
+ * @param registro Ponteiro para o registro de eventos.
+ */
+void descarregarRegistro(RegistroEventos* registro) {
+    if (registro->usado > 0) {
+        if (fwrite(registro->buffer, 1, registro->usado, registro->arquivo) != registro->usado) {
+            registro->falhas++;
+        }
+        registro->usado = 0;
+    }
+}
+
+/**
+ * @brief Grava o evento de fim e os eventos restantes, fecha o arquivo e libera o registro.
+ * O evento de fim leva o total de eventos, o que permite a reproducao detectar logs cortados.
+ * @param registro Ponteiro para o registro de eventos (pode ser NULL).
+ * @return 1 se o log foi gravado por completo, 0 se alguma gravacao falhou.
+ */
+int fecharRegistro(RegistroEventos* registro) {
+    int sucesso = 1;
+    if (registro != NULL) {
+        escreverVarint(registro, EVENTO_FIM);
+        escreverVarint(registro, (unsigned int)registro->numEventos);
+        descarregarRegistro(registro);
+        if (fclose(registro->arquivo) != 0) {
+            registro->falhas++;
+        }
+        if (registro->falhas > 0) {
+            fprintf(stderr, "\nErro: falha ao gravar o log da partida (%lu gravacoes incompletas); o arquivo esta incompleto.\n", registro->falhas);
+            sucesso = 0;
+        } else {
+            printf("\nLog da partida gravado: %lu eventos.\n", registro->numEventos);
+        }
+        free(registro);
+    }
+    return sucesso;
+}
+
+/**
+ * @brief Acrescenta um inteiro sem sinal ao buffer, codificado como varint.
+ * Valores menores que 128 ocupam 1 byte; um int ocupa no maximo 5 bytes.
+ * @param registro Ponteiro para o registro de eventos.
+ * @param valor Valor a ser codificado.
+ */
+void escreverVarint(RegistroEventos* registro, unsigned int valor) {
+    if (registro->usado + 5 > TAM_BUFFER_REGISTRO) {
+        descarregarRegistro(registro);
+    }
+    while (valor >= 0x80) {
+        registro->buffer[registro->usado++] = (unsigned char)(valor | 0x80);
+        valor >>= 7;
+    }
+    registro->buffer[registro->usado++] = (unsigned char)valor;
+}
+
+/**
+ * @brief Registra um evento no log da partida (nao faz nada se o log esta desligado).
+ * Apenas os CAMPOS_EVENTO[tipo] primeiros campos sao gravados.
+ * @param tipo Tipo do evento (EVENTO_*).
+ * @param a Primeiro campo do evento.
+ * @param b Segundo campo do evento.
+ * @param c Terceiro campo do evento.
+ */
+void registrarEvento(int tipo, unsigned int a, unsigned int b, unsigned int c) {
+    if (registroJogo == NULL) {
+        return;
+    }
+    int campos = CAMPOS_EVENTO[tipo];
+    escreverVarint(registroJogo, tipo);
+    if (campos > 0) escreverVarint(registroJogo, a);
+    if (campos > 1) escreverVarint(registroJogo, b);
+    if (campos > 2) escreverVarint(registroJogo, c);
+    registroJogo->numEventos++;
+}
+
+/**
+ * @brief Registra os dados iniciais de um territorio (evento EVENTO_TERRITORIO).
+ * @param indice Indice do territorio no mapa.
+ * @param t Ponteiro constante para o territorio.
+ */
+void registrarTerritorio(int indice, const Territorio* t) {
+    if (registroJogo == NULL) {
+        return;
+    }
+    escreverVarint(registroJogo, EVENTO_TERRITORIO);
+    escreverVarint(registroJogo, indice);
+
+    const char* textos[2] = { t->nome, t->cor };
+    for (int i = 0; i < 2; i++) {
+        size_t tamanho = strlen(textos[i]);
+        escreverVarint(registroJogo, (unsigned int)tamanho);
+        if (registroJogo->usado + tamanho > TAM_BUFFER_REGISTRO) {
+            descarregarRegistro(registroJogo);
+        }
+        memcpy(registroJogo->buffer + registroJogo->usado, textos[i], tamanho);
+        registroJogo->usado += tamanho;
+    }
+
+    escreverVarint(registroJogo, t->tropas);
+    registroJogo->numEventos++;
+}
+
+/**
+ * @brief Decodifica um varint do log.
+ * @param cursor Ponteiro para a posicao atual de leitura (avanca apos o varint).
+ * @param fim Fim dos dados do log.
+ * @param valor Saida: valor decodificado.
+ * @return 1 em caso de sucesso, 0 se o log terminou no meio do varint.
+ */
+int lerVarint(const unsigned char** cursor, const unsigned char* fim, unsigned int* valor) {
+    unsigned int resultado = 0;
+    int deslocamento = 0;
+    while (*cursor < fim && deslocamento < 35) {
+        unsigned char byte = *(*cursor)++;
+        resultado |= (unsigned int)(byte & 0x7F) << deslocamento;
+        if ((byte & 0x80) == 0) {
+            *valor = resultado;
+            return 1;
+        }
+        deslocamento += 7;
+    }
+    return 0;
+}
+
+/**
+ * @brief Reconstroi uma partida a partir do log e da semente gravada nele.
+ * Aplica os eventos ate o fim do turno 'turnoAlvo' e, como auditoria, refaz
+ * com a mesma semente cada sorteio (missao e dados), acusando qualquer
+ * divergencia entre o log e o gerador de numeros aleatorios. Um log sem o
+ * evento de fim (ou com total de eventos diferente) e rejeitado como truncado,
+ * a menos que a reproducao pare antes, no turno alvo.
+ * @param caminho Caminho do arquivo de log.
+ * @param turnoAlvo Ultimo turno a reproduzir (0 = apenas o setup, negativo = partida inteira).
+ * @return 1 se o log foi reproduzido sem divergencias, 0 caso contrario.
+ */
+int reproduzirRegistro(const char* caminho, int turnoAlvo) {
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        perror("Erro ao abrir o arquivo de log");
+        return 0;
+    }
+
+    // 1. Le o log inteiro para a memoria em blocos
+    size_t capacidade = TAM_BUFFER_REGISTRO, tamanho = 0, lidos;
+    unsigned char* dados = (unsigned char*)malloc(capacidade);
+    while (dados != NULL && (lidos = fread(dados + tamanho, 1, capacidade - tamanho, arquivo)) > 0) {
+        tamanho += lidos;
+        if (tamanho == capacidade) {
+            unsigned char* maior = (unsigned char*)realloc(dados, capacidade * 2);
+            if (maior == NULL) {
+                free(dados);
+                dados = NULL;
+            } else {
+                dados = maior;
+                capacidade *= 2;
+            }
+        }
+    }
+    fclose(arquivo);
+    if (dados == NULL) {
+        printf("Erro: memoria insuficiente para ler o log.\n");
+        return 0;
+    }
+
+    // 2. Cabecalho: assinatura, versao e semente
+    const unsigned char* cursor = dados;
+    const unsigned char* fim = dados + tamanho;
+    unsigned int versao = 0, semente = 0;
+    if (tamanho < 4 || memcmp(dados, "WARL", 4) != 0) {
+        printf("Erro: '%s' nao e um log de partida.\n", caminho);
+        free(dados);
+        return 0;
+    }
+    cursor += 4;
+    if (!lerVarint(&cursor, fim, &versao) || versao != VERSAO_REGISTRO || !lerVarint(&cursor, fim, &semente)) {
+        printf("Erro: cabecalho do log invalido.\n");
+        free(dados);
+        return 0;
+    }
+    printf("\n--- Reproduzindo partida (semente %u) ---\n", semente);
+    srand(semente);
+
+    // 3. Aplica os eventos em ordem
+    Territorio* mapa = NULL;
+    unsigned int numTerritorios = 0;
+    int missao = -1;
+    int turno = 0;
+    unsigned long numEventos = 0;
+    int divergencias = 0;
+    int valido = 1;
+    int encerrado = 0;   // 1 quando o evento de fim foi lido
+    int paradoNoAlvo = 0; // 1 quando a reproducao parou no turno alvo
+    while (cursor < fim && valido) {
+        unsigned int tipo, campo[3] = { 0, 0, 0 };
+        // Nada pode vir depois do evento de fim
+        valido = !encerrado && lerVarint(&cursor, fim, &tipo) && tipo >= EVENTO_SETUP && tipo <= EVENTO_FIM;
+        if (!valido) break;
+
+        if (tipo == EVENTO_TERRITORIO) {
+            unsigned int indice, tamanhoTexto;
+            char* textos[2];
+            valido = lerVarint(&cursor, fim, &indice) && mapa != NULL && indice < numTerritorios;
+            if (valido) {
+                textos[0] = (mapa + indice)->nome;
+                textos[1] = (mapa + indice)->cor;
+            }
+            for (int i = 0; i < 2 && valido; i++) {
+                size_t limite = (i == 0) ? sizeof(mapa->nome) : sizeof(mapa->cor);
+                valido = lerVarint(&cursor, fim, &tamanhoTexto) && tamanhoTexto < limite &&
+                         (size_t)(fim - cursor) >= tamanhoTexto;
+                if (valido) {
+                    memcpy(textos[i], cursor, tamanhoTexto);
+                    textos[i][tamanhoTexto] = '\0';
+                    cursor += tamanhoTexto;
+                }
+            }
+            valido = valido && lerVarint(&cursor, fim, &campo[0]);
+            if (valido) {
+                (mapa + indice)->tropas = (int)campo[0];
+            }
+            numEventos++;
+            continue;
+        }
+
+        for (int i = 0; i < CAMPOS_EVENTO[tipo] && valido; i++) {
+            valido = lerVarint(&cursor, fim, &campo[i]);
+        }
+        // Eventos que se referem a territorios precisam de indices validos
+        if (valido && tipo >= EVENTO_ATAQUE && tipo <= EVENTO_PERDA && tipo != EVENTO_DADOS) {
+            valido = (mapa != NULL && campo[0] < numTerritorios &&
+                      (tipo == EVENTO_PERDA || campo[1] < numTerritorios));
+        }
+        if (!valido) break;
+
+        // O turno alvo termina quando o proximo turno comeca
+        if (tipo == EVENTO_TURNO && turnoAlvo >= 0 && (int)campo[0] > turnoAlvo) {
+            paradoNoAlvo = 1;
+            break;
+        }
+        // O evento de fim confere o total de eventos gravados antes dele
+        if (tipo == EVENTO_FIM) {
+            valido = (campo[0] == (unsigned int)numEventos);
+            encerrado = 1;
+            continue;
+        }
+        numEventos++;
+
+        switch (tipo) {
+            case EVENTO_SETUP:
+                free(mapa);
+                numTerritorios = campo[0];
+                mapa = (Territorio*)calloc(numTerritorios > 0 ? numTerritorios : 1, sizeof(Territorio));
+                valido = (mapa != NULL);
+                break;
+            case EVENTO_MISSAO:
+                missao = (int)campo[0];
+                // Auditoria: o sorteio refeito com a semente deve dar a mesma missao
+                if (rand() % MAX_MISSOES != missao) {
+                    printf("Divergencia no evento %lu: missao sorteada nao confere com a semente.\n", numEventos);
+                    divergencias++;
+                }
+                break;
+            case EVENTO_TURNO:
+                turno = (int)campo[0];
+                break;
+            case EVENTO_DADOS: {
+                int dadoAtacante = (rand() % 6) + 1;
+                int dadoDefensor = (rand() % 6) + 1;
+                if (dadoAtacante != (int)campo[0] || dadoDefensor != (int)campo[1]) {
+                    printf("Divergencia no evento %lu (turno %d): dados %u x %u no log, %d x %d pela semente.\n",
+                           numEventos, turno, campo[0], campo[1], dadoAtacante, dadoDefensor);
+                    divergencias++;
+                }
+                break;
+            }
+            case EVENTO_CONQUISTA:
+                strcpy((mapa + campo[1])->cor, (mapa + campo[0])->cor);
+                (mapa + campo[1])->tropas = 0;
+                break;
+            case EVENTO_MOVIMENTO:
+                (mapa + campo[0])->tropas -= (int)campo[2];
+                (mapa + campo[1])->tropas += (int)campo[2];
+                break;
+            case EVENTO_PERDA:
+                (mapa + campo[0])->tropas -= (int)campo[1];
+                break;
+        }
+    }
+    free(dados);
+
+    if (valido && !encerrado && !paradoNoAlvo) {
+        valido = 0; // Terminou sem o evento de fim: log cortado
+    }
+    if (!valido) {
+        printf("Erro: log corrompido ou truncado apos %lu eventos.\n", numEventos);
+        free(mapa);
+        return 0;
+    }
+
+    printf("%lu eventos reproduzidos (ate o turno %d).\n", numEventos, turno);
+    if (mapa != NULL) {
+        exibirMapa(mapa, (int)numTerritorios);
+    }
+    if (missao >= 0 && missao < MAX_MISSOES) {
+        exibirMissao(MISSOES[missao]);
+    }
+    if (divergencias == 0) {
+        printf("Auditoria: todos os sorteios conferem com a semente.\n");
+    } else {
+        printf("Auditoria: %d divergencia(s) entre o log e a semente.\n", divergencias);
+    }
+
+    free(mapa);
+    return divergencias == 0;
+}
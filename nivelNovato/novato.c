@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 // --- Constantes Globais para Manutenibilidade ---
@@ -8,6 +9,8 @@
 #define TAM_NOME 30
 // Define o tamanho máximo para a cor do exército.
 #define TAM_COR 10
+// Define o tamanho de cada bloco lido da entrada no modo lote (1 MiB).
+#define TAM_BLOCO_LEITURA (1 << 20)
 
 // ----------------------------------------------------------------------------
 // ---------------------- DEFINIÇÃO DA ESTRUTURA DE DADOS ---------------------
@@ -25,55 +28,88 @@ typedef struct {
 } Territorio;
 
 
+// ----------------------------------------------------------------------------
+// ---------------------------- PROTÓTIPOS DAS FUNÇÕES ------------------------
+// ----------------------------------------------------------------------------
+
+// Funções do modo lote (cadastro a partir de um arquivo ou da entrada padrão)
+int carregarTerritoriosEmLote(FILE* entrada, Territorio* mapa);
+char* lerEntradaCompleta(FILE* entrada, size_t* tamanho);
+int lerCampo(const char** cursor, const char* fimLinha, const char** inicio);
+
+
 // ----------------------------------------------------------------------------
 // ------------------------------- FUNÇÃO PRINCIPAL -----------------------------
 // ----------------------------------------------------------------------------
 
-int main() {
+int main(int argc, char* argv[]) {
     // Declaração do vetor de structs para armazenar os 5 territórios.
     // Isso cria um array estático na memória com 5 posições do tipo Territorio.
     Territorio mapa[NUM_TERRITORIOS];
     int i; // Variável de controle para os laços 'for'.
 
-    printf("====================================================\n");
-    printf("        CADASTRO INICIAL DE TERRITÓRIOS\n");
-    printf("====================================================\n");
-
     // ------------------------------------------------------------------------
-    // ENTRADA DOS DADOS: Laço para preencher os dados dos 5 territórios.
+    // MODO LOTE: "./novato --lote [arquivo]" lê os 5 territórios de uma vez,
+    // um por linha ("nome cor tropas"), do arquivo ou da entrada padrão.
     // ------------------------------------------------------------------------
-    for (i = 0; i < NUM_TERRITORIOS; i++) {
-        printf("\n--- Cadastrando Território %d de %d ---\n", i + 1, NUM_TERRITORIOS);
-        
-        // 1. Entrada do NOME do território
-        printf("Digite o NOME do território (máx. %d caracteres): ", TAM_NOME - 1);
-        // %29s garante que a string lida não ultrapasse o tamanho de 'nome[30]', 
-        // evitando estouro de buffer, e 'scanf' ignora espaços em branco antes da leitura.
-        if (scanf("%29s", mapa[i].nome) != 1) {
-             // Tratamento de erro básico
-             printf("Erro ao ler o nome. Abortando.\n");
-             return 1;
+    int modoLote = (argc > 1 && strcmp(argv[1], "--lote") == 0);
+    if (modoLote) {
+        FILE* entrada = stdin;
+        if (argc > 2) {
+            entrada = fopen(argv[2], "r");
+            if (entrada == NULL) {
+                perror("Erro ao abrir o arquivo de territórios");
+                return 1;
+            }
         }
-
-        // 2. Entrada da COR do exército
-        printf("Digite a COR do exército dominador (máx. %d caracteres): ", TAM_COR - 1);
-        // Semelhante ao nome, limita a leitura.
-        if (scanf("%9s", mapa[i].cor) != 1) {
-             printf("Erro ao ler a cor. Abortando.\n");
-             return 1;
+        int ok = carregarTerritoriosEmLote(entrada, mapa);
+        if (entrada != stdin) {
+            fclose(entrada);
         }
-
-        // 3. Entrada da QUANTIDADE de tropas
-        printf("Digite o número de TROPAS (valor inteiro): ");
-        if (scanf("%d", &mapa[i].tropas) != 1) {
-             // Se o usuário digitar algo que não é um número inteiro, 'scanf' falhará.
-             printf("Entrada inválida para o número de tropas. Abortando.\n");
-             return 1;
+        if (!ok) {
+            return 1;
         }
+    } else {
+        printf("====================================================\n");
+        printf("        CADASTRO INICIAL DE TERRITÓRIOS\n");
+        printf("====================================================\n");
+
+        // ------------------------------------------------------------------------
+        // ENTRADA DOS DADOS: Laço para preencher os dados dos 5 territórios.
+        // ------------------------------------------------------------------------
+        for (i = 0; i < NUM_TERRITORIOS; i++) {
+            printf("\n--- Cadastrando Território %d de %d ---\n", i + 1, NUM_TERRITORIOS);
         
-        // Em um projeto maior, seria necessário limpar o buffer após o scanf
-        // para evitar problemas, mas para este cadastro simples não é estritamente
-        // necessário, pois todos os campos são lidos com scanf, um após o outro.
+            // 1. Entrada do NOME do território
+            printf("Digite o NOME do território (máx. %d caracteres): ", TAM_NOME - 1);
+            // %29s garante que a string lida não ultrapasse o tamanho de 'nome[30]', 
+            // evitando estouro de buffer, e 'scanf' ignora espaços em branco antes da leitura.
+            if (scanf("%29s", mapa[i].nome) != 1) {
+                 // Tratamento de erro básico
+                 printf("Erro ao ler o nome. Abortando.\n");
+                 return 1;
+            }
+
+            // 2. Entrada da COR do exército
+            printf("Digite a COR do exército dominador (máx. %d caracteres): ", TAM_COR - 1);
+            // Semelhante ao nome, limita a leitura.
+            if (scanf("%9s", mapa[i].cor) != 1) {
+                 printf("Erro ao ler a cor. Abortando.\n");
+                 return 1;
+            }
+
+            // 3. Entrada da QUANTIDADE de tropas
+            printf("Digite o número de TROPAS (valor inteiro): ");
+            if (scanf("%d", &mapa[i].tropas) != 1) {
+                 // Se o usuário digitar algo que não é um número inteiro, 'scanf' falhará.
+                 printf("Entrada inválida para o número de tropas. Abortando.\n");
+                 return 1;
+            }
+        
+            // Em um projeto maior, seria necessário limpar o buffer após o scanf
+            // para evitar problemas, mas para este cadastro simples não é estritamente
+            // necessário, pois todos os campos são lidos com scanf, um após o outro.
+        }
     }
     
     printf("\n====================================================\n");
@@ -100,4 +136,179 @@ int main() {
     printf("Cadastro concluído com sucesso. %d territórios registrados.\n", NUM_TERRITORIOS);
 
     return 0;
-}
\ No newline at end of file
+}
+
+// ----------------------------------------------------------------------------
+// -------------------------- FUNÇÕES DO MODO LOTE ----------------------------
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Lê toda a entrada em blocos grandes (TAM_BLOCO_LEITURA) para um único buffer.
+ * Evita uma chamada de leitura por campo, como acontece com scanf.
+ * @param entrada Arquivo de onde os dados serão lidos.
+ * @param tamanho Ponteiro onde será gravado o número de bytes lidos.
+ * @return O buffer alocado (o chamador deve liberá-lo) ou NULL em caso de falha.
+ */
+char* lerEntradaCompleta(FILE* entrada, size_t* tamanho) {
+    size_t capacidade = TAM_BLOCO_LEITURA;
+    size_t usado = 0;
+    char* buffer = (char*)malloc(capacidade);
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    size_t lidos;
+    while ((lidos = fread(buffer + usado, 1, capacidade - usado, entrada)) > 0) {
+        usado += lidos;
+        if (usado == capacidade) {
+            // Buffer cheio: dobra a capacidade antes do próximo bloco
+            char* maior = (char*)realloc(buffer, capacidade * 2);
+            if (maior == NULL) {
+                free(buffer);
+                return NULL;
+            }
+            buffer = maior;
+            capacidade *= 2;
+        }
+    }
+    if (ferror(entrada)) {
+        free(buffer);
+        return NULL;
+    }
+
+    *tamanho = usado;
+    return buffer;
+}
+
+/**
+ * @brief Tokenizador do modo lote: localiza o próximo campo da linha atual.
+ * Campos são separados por espaços, tabulações ou '\r'.
+ * @param cursor Ponteiro para a posição atual na linha (avança até o fim do campo).
+ * @param fimLinha Ponteiro para o fim da linha atual.
+ * @param inicio Ponteiro onde será gravado o início do campo encontrado.
+ * @return O comprimento do campo, ou 0 se a linha não tem mais campos.
+ */
+int lerCampo(const char** cursor, const char* fimLinha, const char** inicio) {
+    const char* p = *cursor;
+    while (p < fimLinha && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        p++;
+    }
+    *inicio = p;
+    while (p < fimLinha && *p != ' ' && *p != '\t' && *p != '\r') {
+        p++;
+    }
+    *cursor = p;
+    return (int)(p - *inicio);
+}
+
+/**
+ * @brief Cadastra os NUM_TERRITORIOS territórios a partir de uma entrada em lote.
+ * Cada linha tem o formato "nome cor tropas"; linhas em branco são ignoradas.
+ * Respeita os mesmos limites do cadastro interativo (tamanho do nome e da cor,
+ * tropas inteiras) e informa todos os erros encontrados com o número da linha.
+ * @param entrada Arquivo de onde os territórios serão lidos.
+ * @param mapa Vetor estático de NUM_TERRITORIOS posições a ser preenchido.
+ * @return 1 em caso de sucesso, 0 se houver erros.
+ */
+int carregarTerritoriosEmLote(FILE* entrada, Territorio* mapa) {
+    size_t tamanho = 0;
+    char* buffer = lerEntradaCompleta(entrada, &tamanho);
+    if (buffer == NULL) {
+        fprintf(stderr, "Erro ao ler a entrada do modo lote. Abortando.\n");
+        return 0;
+    }
+    const char* fim = buffer + tamanho;
+
+    int n = 0;
+    int erros = 0;
+    int linha = 0;
+    for (const char* p = buffer; p < fim; ) {
+        linha++;
+        const char* fimLinha = memchr(p, '\n', fim - p);
+        if (fimLinha == NULL) {
+            fimLinha = fim;
+        }
+
+        const char* cursor = p;
+        const char* campo[3];
+        int comprimento[3];
+        int numCampos = 0;
+        const char* inicio;
+        int comp;
+        while ((comp = lerCampo(&cursor, fimLinha, &inicio)) > 0) {
+            if (numCampos < 3) {
+                campo[numCampos] = inicio;
+                comprimento[numCampos] = comp;
+            }
+            numCampos++;
+        }
+        p = fimLinha + 1;
+
+        if (numCampos == 0) {
+            continue; // Linha em branco
+        }
+        if (numCampos != 3) {
+            fprintf(stderr, "Linha %d: esperados 3 campos (nome cor tropas), encontrados %d.\n", linha, numCampos);
+            erros++;
+            continue;
+        }
+        if (n >= NUM_TERRITORIOS) {
+            fprintf(stderr, "Linha %d: mais de %d territórios informados.\n", linha, NUM_TERRITORIOS);
+            erros++;
+            continue;
+        }
+        if (comprimento[0] > TAM_NOME - 1) {
+            fprintf(stderr, "Linha %d: nome com mais de %d caracteres.\n", linha, TAM_NOME - 1);
+            erros++;
+            continue;
+        }
+        if (comprimento[1] > TAM_COR - 1) {
+            fprintf(stderr, "Linha %d: cor com mais de %d caracteres.\n", linha, TAM_COR - 1);
+            erros++;
+            continue;
+        }
+
+        // Conversão manual das tropas (apenas dígitos, dentro do limite de um int)
+        const char* d = campo[2];
+        const char* fimCampo = campo[2] + comprimento[2];
+        int negativo = (*d == '-');
+        if (*d == '-' || *d == '+') {
+            d++;
+        }
+        long long tropas = 0;
+        int valido = (d < fimCampo);
+        for (; d < fimCampo && valido; d++) {
+            if (*d < '0' || *d > '9') {
+                valido = 0;
+            } else {
+                tropas = tropas * 10 + (*d - '0');
+                if (tropas > 2147483647LL) {
+                    valido = 0;
+                }
+            }
+        }
+        if (!valido) {
+            fprintf(stderr, "Linha %d: número de tropas inválido (\"%.*s\").\n", linha, comprimento[2], campo[2]);
+            erros++;
+            continue;
+        }
+
+        memcpy(mapa[n].nome, campo[0], comprimento[0]);
+        mapa[n].nome[comprimento[0]] = '\0';
+        memcpy(mapa[n].cor, campo[1], comprimento[1]);
+        mapa[n].cor[comprimento[1]] = '\0';
+        mapa[n].tropas = negativo ? (int)-tropas : (int)tropas;
+        n++;
+    }
+    free(buffer);
+
+    if (erros == 0 && n < NUM_TERRITORIOS) {
+        fprintf(stderr, "Esperados %d territórios, encontrados %d.\n", NUM_TERRITORIOS, n);
+        erros++;
+    }
+    if (erros > 0) {
+        fprintf(stderr, "Cadastro em lote cancelado: %d erro(s) encontrado(s).\n", erros);
+        return 0;
+    }
+    return 1;
+}
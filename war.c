@@ -47,6 +47,10 @@ int main() {
     //   - Opção 2: Verifica se a condição de vitória foi alcançada e informa o jogador.
     //   - Opção 0: Encerra o jogo.
     // - Pausa a execução para que o jogador possa ler os resultados antes da próxima rodada.
+    // - Para rodar várias partidas no mesmo processo, o menu, a fase de ataque e a
+    //   verificação da missão podem ser escritos como corrotinas retomáveis, guiadas
+    //   por um escalonador que só dorme (select) quando todas aguardam entrada
+    //   (ver executarEscalonador() em nivelAventureiro/aventureiro.c).
 
     // 3. Limpeza:
     // - Ao final do jogo, libera a memória alocada para o mapa para evitar vazamentos de memória.